@@ -21,7 +21,18 @@
 
 #include <iostream>
 #include "common.h"
+#include "kanavi_palette.h"
+#include "kanavi_cloud.h"
+#include "kanavi_calibration.h"
+#include "kanavi_crop.h"
+#include "kanavi_voxel.h"
+#include "kanavi_temporal.h"
+#include "kanavi_background.h"
+#include "kanavi_codec.h"
+#include "kanavi_cluster.h"
+#include "kanavi_accumulate.h"
 #include <string>
+#include <sstream>
 
 /**
  * @brief define user structure for argv
@@ -35,6 +46,42 @@ struct argvContainer
 	std::string multicast_ip;	// multicast IP address
 	std::string topicName;		// ROS Node topic Name
 	std::string fixedName;		// ROS Node Fixed Name
+	bool checked_stream;		// publish each channel as soon as it is decoded
+	std::string colorName;		// point color palette (hsv, gray, none)
+	float colorRange;			// distance mapped onto one palette span [m]
+	std::string layout;			// PointCloud2 layout of the frame topic
+	std::string streamLayout;	// PointCloud2 layout of the channel topics (empty = layout)
+	bool checked_organized;		// organized cloud (height = channels, width = beams)
+	std::string rangeImageUnit;	// 16-bit range image unit (cm, mm), empty = off
+	bool checked_scan;			// LaserScan output (R270 : one scan, R2/R4 : one scan per ring)
+	std::string calibPath;		// intrinsic calibration file, empty = specification
+	KANAVI::CALIBRATION::extrinsic pose;	// mounting pose in the fixed frame
+	std::string poseFrame;		// sensor frame of a static TF lookup, empty = pose
+	std::string sensorFrame;	// frame of the range image & LaserScan, empty = poseFrame, then fixedName
+	KANAVI::CROP::config crop;	// range / azimuth / channel / box crop
+	float voxelSize;			// voxel grid leaf size [m], 0 = off
+	std::string voxelPolicy;	// voxel point (centroid, first)
+	std::string temporalMode;	// temporal filter (median, persistence), empty = off
+	int temporalFrames;			// frames in the temporal ring
+	float temporalTolerance;	// persistence range agreement [m]
+	bool checked_background;	// learned background, foreground only output
+	float backgroundTolerance;	// range agreement with the background [m]
+	int backgroundFrames;		// frames a new static range needs to become background
+	int backgroundMinBeams;		// foreground beams of an active frame
+	bool checked_delta;			// keyframe + delta encoded frames
+	float deltaThreshold;		// range change sent in a delta [m]
+	int deltaInterval;			// frames between two keyframes
+	std::string zonePath;		// intrusion zone file, empty = off
+	bool checked_status;		// sensor detection bits & area configuration output
+	bool checked_cluster;		// scan-order clusters
+	float clusterRangeJump;		// range step between two points of an object [m]
+	float clusterAngularGap;	// missing beams bridged inside an object [deg]
+	int clusterMinPoints;		// smaller clusters are dropped
+	int accumulateFrames;		// frames in the sliding window, 0 = off
+	int accumulateDecimation;	// window published every N frames
+	std::string odomTopic;		// odometry for motion compensation, empty = none
+	bool checked_frame;			// native frames, converted to PointCloud2 on demand (ROS2)
+	bool checked_ranges;		// fixed-size range frames, loaned from the middleware (ROS2)
 	
 	argvContainer(){
 		// set defalut Values
@@ -44,6 +91,40 @@ struct argvContainer
 		checked_multicast = false;
 		topicName = KANAVI::COMMON::ROS_TOPIC_NAME;
 		fixedName = KANAVI::COMMON::ROS_FIXED_NAME;
+		checked_stream = false;
+		colorName = KANAVI::PALETTE::HSV;
+		colorRange = KANAVI::PALETTE::DEFAULT_RANGE;
+		layout = KANAVI::CLOUD::LAYOUT_XYZRGB;
+		streamLayout = "";
+		checked_organized = false;
+		rangeImageUnit = "";
+		checked_scan = false;
+		calibPath = "";
+		poseFrame = "";
+		sensorFrame = "";
+		voxelSize = 0;
+		voxelPolicy = KANAVI::VOXEL::CENTROID;
+		temporalMode = "";
+		temporalFrames = KANAVI::TEMPORAL::DEFAULT_FRAMES;
+		temporalTolerance = KANAVI::TEMPORAL::DEFAULT_TOLERANCE;
+		checked_background = false;
+		backgroundTolerance = KANAVI::BACKGROUND::DEFAULT_TOLERANCE;
+		backgroundFrames = KANAVI::BACKGROUND::DEFAULT_FRAMES;
+		backgroundMinBeams = KANAVI::BACKGROUND::DEFAULT_MIN_BEAMS;
+		checked_delta = false;
+		deltaThreshold = KANAVI::CODEC::DEFAULT_THRESHOLD;
+		deltaInterval = KANAVI::CODEC::DEFAULT_KEYFRAME_INTERVAL;
+		zonePath = "";
+		checked_status = false;
+		checked_cluster = false;
+		clusterRangeJump = KANAVI::CLUSTER::DEFAULT_RANGE_JUMP;
+		clusterAngularGap = KANAVI::CLUSTER::DEFAULT_ANGULAR_GAP;
+		clusterMinPoints = KANAVI::CLUSTER::DEFAULT_MIN_POINTS;
+		accumulateFrames = 0;
+		accumulateDecimation = KANAVI::ACCUMULATE::DEFAULT_DECIMATION;
+		odomTopic = "";
+		checked_frame = false;
+		checked_ranges = false;
 	}
 };
 
@@ -99,24 +180,201 @@ inline void argv_parser::parseArgv(const int &argc_, char **argv_)
 
 	for(int i=0; i<argc_; i++)
 	{
-		if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_IP.c_str()))		// check ARGV - IP & port num.
+		if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_IP.c_str()) && i + 2 < argc_)		// check ARGV - IP & port num.
 		{
 			argvResult.local_ip = argv_[i+1];
 			argvResult.port = atoi(argv_[i+2]);
 		}
-		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_Multicast.c_str()))	// check ARGV - udp multicast ip
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_Multicast.c_str()) && i + 1 < argc_)	// check ARGV - udp multicast ip
 		{
 			argvResult.checked_multicast = true;
 			argvResult.multicast_ip = argv_[i+1];
 		}
-		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_FIXED.c_str()))							// check ARGV - ROS Fixed name
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_FIXED.c_str()) && i + 1 < argc_)							// check ARGV - ROS Fixed name
 		{
 			argvResult.fixedName = argv_[i+1];
 		}
-		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_TOPIC.c_str()))							// check ARGV - ROS topic name
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_TOPIC.c_str()) && i + 1 < argc_)							// check ARGV - ROS topic name
 		{
 			argvResult.topicName = argv_[i+1];
 		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_STREAM.c_str()))							// check ARGV - per-channel streaming
+		{
+			argvResult.checked_stream = true;
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_COLOR.c_str()) && i + 1 < argc_)							// check ARGV - color palette
+		{
+			argvResult.colorName = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_COLOR_RANGE.c_str()) && i + 1 < argc_)						// check ARGV - color range mapping
+		{
+			argvResult.colorRange = atof(argv_[i+1]);
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_LAYOUT.c_str()) && i + 1 < argc_)							// check ARGV - frame layout
+		{
+			argvResult.layout = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_STREAM_LAYOUT.c_str()) && i + 1 < argc_)					// check ARGV - channel stream layout
+		{
+			argvResult.streamLayout = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_ORGANIZED.c_str()))						// check ARGV - organized cloud
+		{
+			argvResult.checked_organized = true;
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_RANGE_IMAGE.c_str()) && i + 1 < argc_)						// check ARGV - range image unit
+		{
+			argvResult.rangeImageUnit = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_SCAN.c_str()))								// check ARGV - LaserScan output
+		{
+			argvResult.checked_scan = true;
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_CALIBRATION.c_str()) && i + 1 < argc_)						// check ARGV - calibration file
+		{
+			argvResult.calibPath = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_POSE.c_str()) && i + 6 < argc_)		// check ARGV - mounting pose
+		{
+			argvResult.pose.x = atof(argv_[i+1]);
+			argvResult.pose.y = atof(argv_[i+2]);
+			argvResult.pose.z = atof(argv_[i+3]);
+			argvResult.pose.roll = atof(argv_[i+4]);
+			argvResult.pose.pitch = atof(argv_[i+5]);
+			argvResult.pose.yaw = atof(argv_[i+6]);
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_POSE_TF.c_str()) && i + 1 < argc_)							// check ARGV - mounting pose from TF
+		{
+			argvResult.poseFrame = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_SENSOR_FRAME.c_str()) && i + 1 < argc_)		// check ARGV - sensor frame
+		{
+			argvResult.sensorFrame = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_RANGE.c_str()) && i + 2 < argc_)		// check ARGV - range crop
+		{
+			argvResult.crop.range_min = atof(argv_[i+1]);
+			argvResult.crop.range_max = atof(argv_[i+2]);
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_AZIMUTH.c_str()) && i + 2 < argc_)		// check ARGV - azimuth window
+		{
+			argvResult.crop.azimuth_min = atof(argv_[i+1]);
+			argvResult.crop.azimuth_max = atof(argv_[i+2]);
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_CHANNELS.c_str()) && i + 1 < argc_)		// check ARGV - enabled channels
+		{
+			std::stringstream ss(argv_[i+1]);
+			std::string ch;
+			while(std::getline(ss, ch, ','))
+			{
+				argvResult.crop.channels.push_back(atoi(ch.c_str()));
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_CROP_BOX.c_str()) && i + 6 < argc_)		// check ARGV - crop box
+		{
+			argvResult.crop.box = true;
+			for(int a = 0; a < 3; a++)
+			{
+				argvResult.crop.box_min[a] = atof(argv_[i+1+a]);
+				argvResult.crop.box_max[a] = atof(argv_[i+4+a]);
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_VOXEL.c_str()) && i + 1 < argc_)		// check ARGV - voxel grid
+		{
+			argvResult.voxelSize = atof(argv_[i+1]);
+			if(i + 2 < argc_ && argv_[i+2][0] != '-')	// optional policy
+			{
+				argvResult.voxelPolicy = argv_[i+2];
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_TEMPORAL.c_str()) && i + 1 < argc_)		// check ARGV - temporal filter
+		{
+			argvResult.temporalMode = argv_[i+1];
+			if(i + 2 < argc_ && argv_[i+2][0] != '-')	// optional frames
+			{
+				argvResult.temporalFrames = atoi(argv_[i+2]);
+				if(i + 3 < argc_ && argv_[i+3][0] != '-')	// optional tolerance
+				{
+					argvResult.temporalTolerance = atof(argv_[i+3]);
+				}
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_BACKGROUND.c_str()))		// check ARGV - background model
+		{
+			argvResult.checked_background = true;
+			if(i + 1 < argc_ && argv_[i+1][0] != '-')	// optional tolerance
+			{
+				argvResult.backgroundTolerance = atof(argv_[i+1]);
+				if(i + 2 < argc_ && argv_[i+2][0] != '-')	// optional frames
+				{
+					argvResult.backgroundFrames = atoi(argv_[i+2]);
+					if(i + 3 < argc_ && argv_[i+3][0] != '-')	// optional min beams
+					{
+						argvResult.backgroundMinBeams = atoi(argv_[i+3]);
+					}
+				}
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_DELTA.c_str()))		// check ARGV - delta frames
+		{
+			argvResult.checked_delta = true;
+			if(i + 1 < argc_ && argv_[i+1][0] != '-')	// optional threshold
+			{
+				argvResult.deltaThreshold = atof(argv_[i+1]);
+				if(i + 2 < argc_ && argv_[i+2][0] != '-')	// optional keyframe interval
+				{
+					argvResult.deltaInterval = atoi(argv_[i+2]);
+				}
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_ZONES.c_str()) && i + 1 < argc_)		// check ARGV - intrusion zones
+		{
+			argvResult.zonePath = argv_[i+1];
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_STATUS.c_str()))		// check ARGV - sensor status
+		{
+			argvResult.checked_status = true;
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_CLUSTER.c_str()))		// check ARGV - scan-order clusters
+		{
+			argvResult.checked_cluster = true;
+			if(i + 1 < argc_ && argv_[i+1][0] != '-')	// optional range jump
+			{
+				argvResult.clusterRangeJump = atof(argv_[i+1]);
+				if(i + 2 < argc_ && argv_[i+2][0] != '-')	// optional angular gap
+				{
+					argvResult.clusterAngularGap = atof(argv_[i+2]);
+					if(i + 3 < argc_ && argv_[i+3][0] != '-')	// optional min points
+					{
+						argvResult.clusterMinPoints = atoi(argv_[i+3]);
+					}
+				}
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_ACCUMULATE.c_str()))		// check ARGV - sliding window
+		{
+			argvResult.accumulateFrames = KANAVI::ACCUMULATE::DEFAULT_FRAMES;
+			if(i + 1 < argc_ && argv_[i+1][0] != '-')	// optional frames
+			{
+				argvResult.accumulateFrames = atoi(argv_[i+1]);
+				if(i + 2 < argc_ && argv_[i+2][0] != '-')	// optional decimation
+				{
+					argvResult.accumulateDecimation = atoi(argv_[i+2]);
+					if(i + 3 < argc_ && argv_[i+3][0] != '-')	// optional odometry topic
+					{
+						argvResult.odomTopic = argv_[i+3];
+					}
+				}
+			}
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_FRAME.c_str()))		// check ARGV - native frames
+		{
+			argvResult.checked_frame = true;
+		}
+		else if(!strcmp(argv_[i], KANAVI::ROS::PARAMETER_RANGES.c_str()))		// check ARGV - loaned range frames
+		{
+			argvResult.checked_ranges = true;
+		}
 	}
 
 }
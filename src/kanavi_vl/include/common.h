@@ -21,6 +21,32 @@ namespace KANAVI
 		const std::string PARAMETER_PORT	= "-p";
 		const std::string PARAMETER_Multicast = "-m";
 		const std::string PARAMETER_Help	= "-h";
+		const std::string PARAMETER_STREAM	= "-stream";
+		const std::string PARAMETER_COLOR	= "-color";
+		const std::string PARAMETER_COLOR_RANGE	= "-color_range";
+		const std::string PARAMETER_LAYOUT	= "-layout";
+		const std::string PARAMETER_STREAM_LAYOUT	= "-stream_layout";
+		const std::string PARAMETER_ORGANIZED	= "-organized";
+		const std::string PARAMETER_RANGE_IMAGE	= "-range_image";
+		const std::string PARAMETER_SCAN	= "-scan";
+		const std::string PARAMETER_CALIBRATION	= "-calib";
+		const std::string PARAMETER_POSE	= "-pose";
+		const std::string PARAMETER_POSE_TF	= "-pose_tf";
+		const std::string PARAMETER_SENSOR_FRAME	= "-sensor_frame";
+		const std::string PARAMETER_RANGE	= "-range";
+		const std::string PARAMETER_AZIMUTH	= "-azimuth";
+		const std::string PARAMETER_CHANNELS	= "-channels";
+		const std::string PARAMETER_CROP_BOX	= "-crop_box";
+		const std::string PARAMETER_VOXEL	= "-voxel";
+		const std::string PARAMETER_TEMPORAL	= "-temporal";
+		const std::string PARAMETER_BACKGROUND	= "-background";
+		const std::string PARAMETER_DELTA	= "-delta";
+		const std::string PARAMETER_ZONES	= "-zones";
+		const std::string PARAMETER_STATUS	= "-status";
+		const std::string PARAMETER_CLUSTER	= "-cluster";
+		const std::string PARAMETER_ACCUMULATE	= "-accumulate";
+		const std::string PARAMETER_FRAME	= "-frame";
+		const std::string PARAMETER_RANGES	= "-ranges";
 	};
 
 	namespace COMMON
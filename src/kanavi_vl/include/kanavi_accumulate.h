@@ -0,0 +1,133 @@
+#ifndef __KANAVI_ACCUMULATE_H__
+#define __KANAVI_ACCUMULATE_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_accumulate.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief sliding window of the last frames, optionally motion compensated
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstddef>
+
+namespace KANAVI
+{
+	namespace ACCUMULATE
+	{
+		const int DEFAULT_FRAMES = 10;		// frames in the window
+		const int DEFAULT_DECIMATION = 5;	// window published every N frames
+		const int MAX_FRAMES = 100;
+	}
+}
+
+/**
+ * @class kanavi_accumulate
+ * @brief Ring of the last N frames for sparse (R2, R270) sensors.
+ *
+ * The window is one organized buffer owned by the caller, a row per frame
+ * (slot) of channels x beams points. A new frame overwrites the oldest row
+ * in place, so publishing the window never copies the frames again; rows
+ * are in ring order, not in time order.
+ * With a pose (odometry, latest sample) the points are moved into the
+ * odometry frame when they are written, frames taken while moving line up
+ * without being transformed again at publish time.
+ */
+class kanavi_accumulate
+{
+private:
+	/* data */
+	int frames_;
+	int decimation_;
+	size_t capacity_;	// points per slot
+
+	int next_;			// slot of the next frame
+	int filled_;		// slots holding a frame
+	int since_publish_;
+
+	// odometry frame <- output frame
+	float r_[9];
+	float t_[3];
+	bool has_pose_;
+
+public:
+/**
+ * @brief Constructor for kanavi_accumulate.
+ * @param frames Frames in the window.
+ * @param decimation Window published every N frames.
+ * @param capacity Points per frame (channels x beams).
+ * @throws std::runtime_error on invalid settings.
+ */
+	kanavi_accumulate(int frames, int decimation, size_t capacity);
+	~kanavi_accumulate();
+
+/**
+ * @brief Sets the latest pose of the output frame in the odometry frame.
+ * @param x Position X [m].
+ * @param y Position Y [m].
+ * @param z Position Z [m].
+ * @param qx Orientation quaternion X.
+ * @param qy Orientation quaternion Y.
+ * @param qz Orientation quaternion Z.
+ * @param qw Orientation quaternion W.
+ */
+	void setPose(double x, double y, double z, double qx, double qy, double qz, double qw);
+
+/**
+ * @brief Returns true once a pose was set.
+ */
+	bool hasPose() const { return has_pose_; }
+
+/**
+ * @brief Starts a new frame in the oldest slot.
+ * @return First point index of the slot in the window buffer.
+ */
+	size_t begin();
+
+/**
+ * @brief Moves one row of points into the odometry frame, in place (no-op without a pose).
+ * @param x X row.
+ * @param y Y row.
+ * @param z Z row.
+ * @param count Number of points.
+ */
+	void transform(float *x, float *y, float *z, int count) const;
+
+/**
+ * @brief Ends the frame.
+ * @return true if the window is due for publishing (every decimation frames).
+ */
+	bool end();
+
+/**
+ * @brief Returns the number of frames in the window.
+ */
+	int getFrames() const { return frames_; }
+
+/**
+ * @brief Returns the number of slots holding a frame.
+ */
+	int getFilled() const { return filled_; }
+
+/**
+ * @brief Returns the publishing decimation.
+ */
+	int getDecimation() const { return decimation_; }
+
+/**
+ * @brief Returns the points per slot.
+ */
+	size_t getCapacity() const { return capacity_; }
+};
+
+#endif // __KANAVI_ACCUMULATE_H__
@@ -0,0 +1,132 @@
+#ifndef __KANAVI_BACKGROUND_H__
+#define __KANAVI_BACKGROUND_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_background.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief learned per-beam static background and foreground mask
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace BACKGROUND
+	{
+		const float DEFAULT_TOLERANCE = 0.2f;	// [m], range agreement with the background
+		const int DEFAULT_FRAMES = 50;			// frames a new static range needs to become background
+		const int DEFAULT_MIN_BEAMS = 3;		// foreground beams of an active frame
+		const int EMA_SHIFT = 3;				// background follows agreeing returns by 1/8
+	}
+}
+
+/**
+ * @class kanavi_background
+ * @brief Learns the static range of every (channel, beam) of a fixed mounted sensor.
+ *
+ * Each beam keeps a background range and one candidate range (int16 cm).
+ * A return agreeing with the background within the tolerance refines it,
+ * anything else builds up the candidate, which replaces the background
+ * once it stayed for the adaptation frames (parked objects, a door left
+ * open, the first frame being taken while someone walked by).
+ * A beam is foreground when it returns closer than its background, or
+ * returns at all where the background has none; a frame is active with at
+ * least min beams of foreground. Nothing is foreground while the first
+ * adaptation frames are learned.
+ */
+class kanavi_background
+{
+private:
+	/* data */
+	int16_t tolerance_;		// [cm]
+	int frames_;			// adaptation frames
+	int min_beams_;
+
+	int channels_;
+	int beams_;
+
+	// index = ch * beams_ + beam, ranges [cm], 0 = no return
+	std::vector<int16_t> background_;
+	std::vector<int16_t> candidate_;
+	std::vector<uint16_t> candidate_count_;
+	std::vector<uint8_t> foreground_;
+
+	int learned_;		// frames seen, saturates at frames_
+	size_t foreground_count_;
+
+public:
+/**
+ * @brief Constructor for kanavi_background.
+ * @param tolerance Range agreement with the background [m].
+ * @param frames Frames a new static range needs to become background.
+ * @param min_beams Foreground beams of an active frame.
+ * @param channels Number of channels of the grid.
+ * @param beams Number of beams per channel.
+ * @throws std::runtime_error on invalid settings.
+ */
+	kanavi_background(float tolerance, int frames, int min_beams, int channels, int beams);
+	~kanavi_background();
+
+/**
+ * @brief Classifies one frame against the background, then learns from it.
+ * @param len_buf Range rows of the frame [m], one per channel.
+ */
+	void update(const std::vector< std::vector<float> > &len_buf);
+
+/**
+ * @brief Clears a validity row where the beam is not foreground.
+ * @param ch Channel index.
+ * @param count Number of beams in valid.
+ * @param valid Validity row (count elements), 1 = keep.
+ * @return Number of beams left valid.
+ */
+	int mask(int ch, int count, uint8_t *valid) const;
+
+/**
+ * @brief Returns true once the first adaptation frames have been learned.
+ */
+	bool isLearned() const { return learned_ >= frames_; }
+
+/**
+ * @brief Returns true if the last frame had at least min beams of foreground.
+ */
+	bool isActive() const { return foreground_count_ >= static_cast<size_t>(min_beams_); }
+
+/**
+ * @brief Returns the number of foreground beams of the last frame.
+ */
+	size_t getForegroundCount() const { return foreground_count_; }
+
+/**
+ * @brief Returns the background range of a beam [m], 0 = no static return.
+ * @param ch Channel index.
+ * @param beam Beam index.
+ */
+	float getBackground(int ch, int beam) const { return background_[static_cast<size_t>(ch) * beams_ + beam] * 0.01f; }
+
+/**
+ * @brief Returns the range agreement with the background [m].
+ */
+	float getTolerance() const { return tolerance_ * 0.01f; }
+
+/**
+ * @brief Returns the adaptation frames.
+ */
+	int getFrames() const { return frames_; }
+};
+
+#endif // __KANAVI_BACKGROUND_H__
@@ -0,0 +1,135 @@
+#ifndef __KANAVI_CALIBRATION_H__
+#define __KANAVI_CALIBRATION_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_calibration.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief per-sensor intrinsic calibration file and mounting pose
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * One section per sensor, keyed by the sender IP of its datagrams.
+ * [default] is used for sensors without their own section.
+ * Lists are separated by spaces or commas, a single value applies to all.
+ *
+ * ex)	# R4 on the front bumper
+ * 		[192.168.123.200]
+ * 		vertical = -1.61 -0.54 0.53 1.60	# per channel [deg]
+ * 		azimuth_offset = 0.02				# per beam [deg]
+ * 		range_offset = 0.03					# per channel [m]
+ * 		range_scale = 1.0					# per channel
+ */
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <ctime>
+
+namespace KANAVI
+{
+	namespace CALIBRATION
+	{
+		const std::string DEFAULT_SECTION = "default";
+		const int64_t RELOAD_PERIOD_MS = 1000;	// sender / file change polling
+		const double TF_TIMEOUT = 5.0;			// static mounting pose lookup [s]
+
+		const std::string KEY_VERTICAL = "vertical";
+		const std::string KEY_AZIMUTH_OFFSET = "azimuth_offset";
+		const std::string KEY_RANGE_OFFSET = "range_offset";
+		const std::string KEY_RANGE_SCALE = "range_scale";
+
+		/**
+		 * @brief correction of one sensor, an empty list keeps the specification value
+		 */
+		struct intrinsic
+		{
+			std::vector<float> vertical;		// per channel elevation [deg]
+			std::vector<float> azimuth_offset;	// per beam, added to the azimuth [deg]
+			std::vector<float> range_offset;	// per channel [m]
+			std::vector<float> range_scale;		// per channel
+		};
+
+		/**
+		 * @brief mounting pose of the sensor in the output frame, p_out = R * p_sensor + t
+		 */
+		struct extrinsic
+		{
+			float x, y, z;				// translation [m]
+			float roll, pitch, yaw;		// R = Rz(yaw) * Ry(pitch) * Rx(roll) [deg]
+
+			extrinsic() : x(0), y(0), z(0), roll(0), pitch(0), yaw(0) {}
+
+			bool hasTranslation() const { return x != 0 || y != 0 || z != 0; }
+		};
+	}
+}
+
+/**
+ * @class kanavi_calibration
+ * @brief Loads the calibration file and looks up the section of a sensor.
+ *
+ * The file is parsed as a whole on load(), a file with errors is rejected
+ * and the previously loaded sections are kept. isModified() only compares
+ * the modification time, the caller decides how often to poll it.
+ */
+class kanavi_calibration
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Returns the modification time of the file, 0 if it can not be read.
+ */
+	time_t modifiedTime() const;
+	// !FUNTCIONS---
+
+	/* data */
+	std::string path_;
+	time_t mtime_;
+
+	std::map<std::string, KANAVI::CALIBRATION::intrinsic> sections_;
+
+public:
+/**
+ * @brief Constructor for kanavi_calibration, loads the file once.
+ * @param path Calibration file path.
+ * @throws std::runtime_error if the file can not be loaded.
+ */
+	explicit kanavi_calibration(const std::string &path);
+	~kanavi_calibration();
+
+/**
+ * @brief (Re)loads the file.
+ * @return false if the file can not be read or has errors, the old sections are kept.
+ */
+	bool load();
+
+/**
+ * @brief Checks whether the file changed since the last load().
+ */
+	bool isModified() const;
+
+/**
+ * @brief Looks up the correction of a sensor.
+ * @param ip Sender IP of the sensor, falls back to [default].
+ * @param out Correction of the sensor.
+ * @return false if neither the sensor nor [default] has a section.
+ */
+	bool find(const std::string &ip, KANAVI::CALIBRATION::intrinsic &out) const;
+
+/**
+ * @brief Returns the calibration file path.
+ */
+	const std::string &getPath() const { return path_; }
+};
+
+#endif // __KANAVI_CALIBRATION_H__
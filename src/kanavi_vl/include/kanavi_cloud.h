@@ -0,0 +1,171 @@
+#ifndef __KANAVI_CLOUD_H__
+#define __KANAVI_CLOUD_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_cloud.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief PointCloud2 field layouts and direct data writer (no pcl::PointCloud)
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kanavi_palette.h"
+
+namespace KANAVI
+{
+	namespace CLOUD
+	{
+		// same values as sensor_msgs/PointField
+		enum DATATYPE
+		{
+			INT8 = 1,
+			UINT8 = 2,
+			INT16 = 3,
+			UINT16 = 4,
+			INT32 = 5,
+			UINT32 = 6,
+			FLOAT32 = 7,
+			FLOAT64 = 8
+		};
+
+		enum LAYOUT
+		{
+			XYZ = 0,	// x, y, z float32						(12 byte)
+			XYZRGB,		// x, y, z float32 + rgb				(16 byte)
+			XYZRBR,		// x, y, z float32 + ring, beam uint16 + range float32	(20 byte)
+			XYZ16		// x, y, z int16 [mm]					(6 byte)
+		};
+
+		const std::string LAYOUT_XYZ	= "xyz";
+		const std::string LAYOUT_XYZRGB	= "xyzrgb";
+		const std::string LAYOUT_XYZRBR	= "xyzrbr";
+		const std::string LAYOUT_XYZ16	= "xyz16";
+
+		/**
+		 * @brief ROS independent copy of sensor_msgs/PointField
+		 */
+		struct field
+		{
+			std::string name;
+			uint32_t offset;
+			uint8_t datatype;
+			uint32_t count;
+		};
+	}
+}
+
+/**
+ * @class kanavi_cloud
+ * @brief Writes projected points straight into a PointCloud2 data buffer.
+ *
+ * The field layout is computed once; write() interleaves the x/y/z rows of
+ * the projection kernel (and the per-layout extra fields) into point_step
+ * sized records, so the node can fill a preallocated, reused message without
+ * an intermediate pcl::PointCloud or toROSMsg copy.
+ *
+ * XYZ16 stores millimetres; points beyond +-32.767 m are treated like a beam
+ * without return (skipped, or 0, 0, 0 in an organized cloud).
+ *
+ * Beams flagged invalid are skipped, or kept as NaN (0 for XYZ16) when the
+ * cloud is organized so that (ring, beam) stays addressable.
+ */
+class kanavi_cloud
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Appends a field at the end of the current point record.
+ * @param name Field name.
+ * @param datatype KANAVI::CLOUD::DATATYPE.
+ * @param size Field size [byte].
+ */
+	void addField(const std::string &name, uint8_t datatype, uint32_t size);
+	// !FUNTCIONS---
+
+	/* data */
+	KANAVI::CLOUD::LAYOUT layout_;
+	std::string name_;
+	bool organized_;
+	std::vector<KANAVI::CLOUD::field> fields_;
+	uint32_t point_step_;	// [byte]
+
+public:
+/**
+ * @brief Constructor for kanavi_cloud with a specific layout.
+ * @param layout Layout name (KANAVI::CLOUD::LAYOUT_*).
+ * @param organized Keep invalid beams as NaN instead of dropping them.
+ */
+	kanavi_cloud(const std::string &layout, bool organized = false);
+	~kanavi_cloud();
+
+/**
+ * @brief Returns the PointCloud2 fields of the layout.
+ */
+	const std::vector<KANAVI::CLOUD::field> &getFields() const { return fields_; }
+
+/**
+ * @brief Returns the size of one point record [byte].
+ */
+	uint32_t getPointStep() const { return point_step_; }
+
+/**
+ * @brief Returns the layout in use.
+ */
+	KANAVI::CLOUD::LAYOUT getLayout() const { return layout_; }
+
+/**
+ * @brief Returns the layout name in use.
+ */
+	const std::string &getName() const { return name_; }
+
+/**
+ * @brief Returns true if invalid beams are kept in place (organized cloud).
+ */
+	bool isOrganized() const { return organized_; }
+
+/**
+ * @brief Returns true if the layout carries a color field.
+ */
+	bool hasColor() const { return layout_ == KANAVI::CLOUD::XYZRGB; }
+
+/**
+ * @brief Writes one channel of projected points.
+ * @param dst Destination, at least count * getPointStep() bytes.
+ * @param x X row from the projection kernel.
+ * @param y Y row from the projection kernel.
+ * @param z Z row from the projection kernel.
+ * @param len Range row [m].
+ * @param valid Validity row (0 = invalid), nullptr = every beam valid.
+ * @param ch Channel index (ring field).
+ * @param count Number of beams, beam index = 0 .. count - 1.
+ * @param palette Range -> color table (XYZRGB only).
+ * @return Number of points written.
+ */
+	int write(uint8_t *dst, const float *x, const float *y, const float *z, const float *len,
+			  const uint8_t *valid, int ch, int count, const kanavi_palette &palette) const;
+
+/**
+ * @brief Writes invalid points (NaN / 0) for beams without data.
+ * @param dst Destination, at least count * getPointStep() bytes.
+ * @param ch Channel index (ring field).
+ * @param first First beam index.
+ * @param count Number of points.
+ */
+	void writeInvalid(uint8_t *dst, int ch, int first, int count) const;
+};
+
+#endif // __KANAVI_CLOUD_H__
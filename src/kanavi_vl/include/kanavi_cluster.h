@@ -0,0 +1,156 @@
+#ifndef __KANAVI_CLUSTER_H__
+#define __KANAVI_CLUSTER_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_cluster.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief linear scan-order clustering (bounding box, centroid, point count)
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace CLUSTER
+	{
+		const float DEFAULT_RANGE_JUMP = 0.3f;	// [m], range step between two points of an object
+		const float DEFAULT_ANGULAR_GAP = 1.0f;	// [deg], missing beams bridged inside an object
+		const int DEFAULT_MIN_POINTS = 3;		// smaller clusters are dropped
+
+		const int FIELDS = 10;	// centroid xyz, min xyz, max xyz, count
+
+		/**
+		 * @brief one object of a frame
+		 */
+		struct cluster
+		{
+			float centroid[3];
+			float min[3];
+			float max[3];
+			uint32_t count;
+		};
+	}
+}
+
+/**
+ * @class kanavi_cluster
+ * @brief Segments a frame into objects in one pass along scan order.
+ *
+ * Rows arrive sorted by beam, so a point joins the segment of the previous
+ * valid point of its ring when the range step stays below the range jump
+ * and at most the angular gap of beams is missing in between. A point also
+ * joins the segment of the same beam on the previous ring (R2 / R4) under
+ * the same range jump, segments are merged with a union-find. Every buffer
+ * is sized once for channels x beams, a frame never allocates.
+ */
+class kanavi_cluster
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Returns the root segment of a segment (path halving).
+ */
+	uint32_t find(uint32_t s);
+	// !FUNTCIONS---
+
+	/* data */
+	float range_jump_;	// [m]
+	float angular_gap_;	// [deg]
+	int max_gap_;		// missing beams bridged
+	int min_points_;
+	int beams_;
+
+	// per segment, sums until finish()
+	std::vector<uint32_t> parent_;
+	std::vector<uint32_t> count_;
+	std::vector<float> sum_;	// x y z
+	std::vector<float> min_;	// x y z
+	std::vector<float> max_;	// x y z
+	uint32_t used_;
+
+	// segment & range per beam of the previous / current ring
+	std::vector<uint32_t> prev_segment_;
+	std::vector<float> prev_len_;
+	std::vector<uint32_t> cur_segment_;
+	std::vector<float> cur_len_;
+	int prev_ch_;		// -1 = no ring to merge with
+
+	std::vector<KANAVI::CLUSTER::cluster> clusters_;
+
+public:
+/**
+ * @brief Constructor for kanavi_cluster.
+ * @param range_jump Range step between two points of an object [m].
+ * @param angular_gap Missing beams bridged inside an object [deg].
+ * @param min_points Smaller clusters are dropped.
+ * @param channels Number of channels of the grid.
+ * @param beams Number of beams per channel.
+ * @param h_resolution Horizontal angle between two beams [deg].
+ * @throws std::runtime_error on invalid settings.
+ */
+	kanavi_cluster(float range_jump, float angular_gap, int min_points, int channels, int beams, double h_resolution);
+	~kanavi_cluster();
+
+/**
+ * @brief Starts a new frame, O(1).
+ */
+	void clear();
+
+/**
+ * @brief Adds one ring of points, rings in increasing channel order.
+ * @param ch Channel index, a skipped channel breaks the merge across rings.
+ * @param x X row.
+ * @param y Y row.
+ * @param z Z row.
+ * @param len Range row [m].
+ * @param valid Validity row (0 = skip), nullptr = every point with a return.
+ * @param count Number of points (<= beams).
+ */
+	void insert(int ch, const float *x, const float *y, const float *z, const float *len, const uint8_t *valid, int count);
+
+/**
+ * @brief Merges the segments into clusters, call once after the last insert().
+ */
+	void finish();
+
+/**
+ * @brief Returns the number of clusters of the frame.
+ */
+	size_t size() const { return clusters_.size(); }
+
+/**
+ * @brief Returns the clusters of the frame (after finish()), in scan order of their first point.
+ */
+	const std::vector<KANAVI::CLUSTER::cluster> &getClusters() const { return clusters_; }
+
+/**
+ * @brief Returns the range step between two points of an object [m].
+ */
+	float getRangeJump() const { return range_jump_; }
+
+/**
+ * @brief Returns the missing beams bridged inside an object [deg].
+ */
+	float getAngularGap() const { return angular_gap_; }
+
+/**
+ * @brief Returns the smallest cluster kept.
+ */
+	int getMinPoints() const { return min_points_; }
+};
+
+#endif // __KANAVI_CLUSTER_H__
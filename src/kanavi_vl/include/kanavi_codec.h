@@ -0,0 +1,187 @@
+#ifndef __KANAVI_CODEC_H__
+#define __KANAVI_CODEC_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_codec.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief keyframe + delta range frame codec (encoder for the node, decoder for consumers)
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Frame layout (ranges in cm, varint = LEB128, zigzag for signed values)
+ *   byte 0   : version (KANAVI::CODEC::VERSION)
+ *   byte 1   : type (KEYFRAME / DELTA)
+ *   varint   : sequence, +1 per frame
+ *   varint   : channels
+ *   varint   : beams
+ *   KEYFRAME : channels x beams zigzag varint, range - previous range in scan order
+ *   DELTA    : { varint skip, varint run, run x zigzag varint (range - reference) } ...
+ *              until the grid is covered or the data ends
+ * The reference of a beam is the last range sent for it, encoder and decoder
+ * hold the same grid, so the error never grows beyond the threshold.
+ * This header does not depend on ROS.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace CODEC
+	{
+		const uint8_t VERSION = 1;
+
+		enum TYPE
+		{
+			KEYFRAME = 0,
+			DELTA = 1
+		};
+
+		const float DEFAULT_THRESHOLD = 0.02f;	// [m], smaller changes are not sent
+		const int DEFAULT_KEYFRAME_INTERVAL = 10;	// frames
+
+		namespace DecodeResult
+		{
+			const int FAIL = -1;			// corrupt or unsupported frame
+			const int NEED_KEYFRAME = 0;	// delta without its reference, wait for a keyframe
+			const int SUCCESS = 1;
+		} // namespace DecodeResult
+	}
+}
+
+/**
+ * @class kanavi_delta_encoder
+ * @brief Encodes range frames as a keyframe every interval frames and deltas in between.
+ *
+ * A delta carries only the beams whose range moved more than the threshold
+ * from their reference, grouped in runs. A static scene costs a few bytes
+ * per frame. The output buffer is reused between frames.
+ */
+class kanavi_delta_encoder
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Writes the frame header.
+ */
+	void writeHeader(uint8_t type);
+	// !FUNTCIONS---
+
+	/* data */
+	int channels_;
+	int beams_;
+	uint16_t threshold_;	// [cm]
+	int interval_;
+
+	std::vector<uint16_t> reference_;	// last sent range per beam [cm]
+	std::vector<uint16_t> current_;		// frame being encoded [cm]
+	std::vector<uint8_t> out_;
+	uint32_t sequence_;
+	int since_keyframe_;
+	bool keyframe_;			// last frame was a keyframe
+	bool force_keyframe_;
+
+public:
+/**
+ * @brief Constructor for kanavi_delta_encoder.
+ * @param channels Number of channels of the grid.
+ * @param beams Number of beams per channel.
+ * @param threshold Range change sent in a delta [m].
+ * @param interval Frames between two keyframes (1 = keyframes only).
+ * @throws std::runtime_error on invalid settings.
+ */
+	kanavi_delta_encoder(int channels, int beams, float threshold, int interval);
+	~kanavi_delta_encoder();
+
+/**
+ * @brief Encodes one frame.
+ * @param len_buf Range rows of the frame [m], one per channel.
+ * @return Encoded frame, valid until the next call.
+ */
+	const std::vector<uint8_t> &encode(const std::vector< std::vector<float> > &len_buf);
+
+/**
+ * @brief Makes the next frame a keyframe (frames were skipped or a consumer joined).
+ */
+	void requestKeyframe() { force_keyframe_ = true; }
+
+/**
+ * @brief Returns true if the last encoded frame was a keyframe.
+ */
+	bool isKeyframe() const { return keyframe_; }
+
+/**
+ * @brief Returns the range change sent in a delta [m].
+ */
+	float getThreshold() const { return threshold_ * 0.01f; }
+
+/**
+ * @brief Returns the frames between two keyframes.
+ */
+	int getInterval() const { return interval_; }
+};
+
+/**
+ * @class kanavi_delta_decoder
+ * @brief Rebuilds the range grid from keyframes and deltas.
+ *
+ * The grid takes its size from the keyframes. A delta is only applied on top
+ * of the frame right before it, after a lost frame every delta reports
+ * NEED_KEYFRAME until the next keyframe arrives.
+ */
+class kanavi_delta_decoder
+{
+private:
+	/* data */
+	int channels_;
+	int beams_;
+	std::vector<uint16_t> grid_;	// [cm]
+	std::vector<float> range_;		// [m]
+	uint32_t sequence_;
+	bool synced_;
+
+public:
+	kanavi_delta_decoder();
+	~kanavi_delta_decoder();
+
+/**
+ * @brief Applies one encoded frame.
+ * @param data Encoded frame.
+ * @param size Size of data in bytes.
+ * @return KANAVI::CODEC::DecodeResult value.
+ */
+	int decode(const uint8_t *data, size_t size);
+
+/**
+ * @brief Returns the number of channels of the grid (0 before the first keyframe).
+ */
+	int getChannels() const { return channels_; }
+
+/**
+ * @brief Returns the number of beams per channel (0 before the first keyframe).
+ */
+	int getBeams() const { return beams_; }
+
+/**
+ * @brief Returns the sequence number of the last decoded frame.
+ */
+	uint32_t getSequence() const { return sequence_; }
+
+/**
+ * @brief Returns the range row of a channel [m], 0 = no return.
+ * @param ch Channel index.
+ */
+	const float *getRow(int ch) const { return range_.data() + static_cast<size_t>(ch) * beams_; }
+};
+
+#endif // __KANAVI_CODEC_H__
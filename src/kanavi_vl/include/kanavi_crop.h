@@ -0,0 +1,109 @@
+#ifndef __KANAVI_CROP_H__
+#define __KANAVI_CROP_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_crop.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief range / azimuth / channel / box crop reduced to a range interval per beam
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstdint>
+#include <vector>
+
+class kanavi_projection;
+
+namespace KANAVI
+{
+	namespace CROP
+	{
+		const float RANGE_UNLIMITED = 1e9f;	// [m], default range_max
+
+		/**
+		 * @brief crop settings, the defaults keep every return
+		 */
+		struct config
+		{
+			float range_min;			// [m], measured range
+			float range_max;			// [m]
+			float azimuth_min;			// [deg], sensor frame (base rotation included)
+			float azimuth_max;			// [deg]
+			std::vector<int> channels;	// enabled channels, empty = all
+			bool box;					// axis-aligned box in the output frame
+			float box_min[3];			// x, y, z [m]
+			float box_max[3];			// x, y, z [m]
+
+			config() : range_min(0), range_max(RANGE_UNLIMITED), azimuth_min(-180), azimuth_max(180), box(false),
+					   box_min{0, 0, 0}, box_max{0, 0, 0} {}
+
+			bool isActive() const
+			{
+				return range_min > 0 || range_max < RANGE_UNLIMITED || azimuth_max - azimuth_min < 360 || !channels.empty() || box;
+			}
+		};
+	}
+}
+
+/**
+ * @class kanavi_crop
+ * @brief Precomputes an accepted range interval for every (channel, beam).
+ *
+ * A point is range * direction + offset, so along one beam the range limits,
+ * the azimuth window, the channel enable and the crop box all collapse into a
+ * single [lo, hi] range interval (the box by a ray / slab intersection).
+ * Rejected beams get an empty interval. Per frame only two compares per beam
+ * are left, zero returns always fail since lo > 0.
+ * The intervals follow the projection, rebuild the crop with it.
+ */
+class kanavi_crop
+{
+private:
+	/* data */
+	int channels_;
+	int beams_;
+
+	// accepted range interval [m], index = ch * beams_ + beam
+	std::vector<float> lo_;
+	std::vector<float> hi_;
+
+	// channel with at least one accepted beam
+	std::vector<uint8_t> enabled_;
+
+public:
+/**
+ * @brief Constructor for kanavi_crop.
+ * @param cfg Crop settings.
+ * @param projection Direction / offset tables the points are made with.
+ */
+	kanavi_crop(const KANAVI::CROP::config &cfg, const kanavi_projection &projection);
+	~kanavi_crop();
+
+/**
+ * @brief Returns false if no beam of the channel can pass (skip its projection).
+ * @param ch Channel index.
+ */
+	bool isChannelEnabled(int ch) const { return ch >= 0 && ch < channels_ && enabled_[ch]; }
+
+/**
+ * @brief Fills the validity row of one channel.
+ * @param len Range row [m].
+ * @param ch Channel index.
+ * @param count Number of ranges in len.
+ * @param valid Output validity row (count elements), 1 = keep.
+ * @return Number of accepted beams.
+ */
+	int mask(const float *len, int ch, int count, uint8_t *valid) const;
+};
+
+#endif // __KANAVI_CROP_H__
@@ -0,0 +1,93 @@
+#ifndef __KANAVI_IMAGE_H__
+#define __KANAVI_IMAGE_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_image.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief channels x beams 16-bit range image writer
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace IMAGE
+	{
+		const std::string UNIT_CM	= "cm";		// 1 cm / count, up to 655.35 m
+		const std::string UNIT_MM	= "mm";		// 1 mm / count, up to 65.535 m (saturated)
+
+		const std::string ENCODING	= "mono16";
+		const uint16_t NO_RETURN	= 0;
+		const uint16_t SATURATED	= 0xFFFF;
+	}
+}
+
+/**
+ * @class kanavi_image
+ * @brief Writes the decoded range rows as a row-major 16-bit image.
+ *
+ * Row = channel, column = beam, pixel = range quantized to the selected unit.
+ * No projection is involved; beam angles are published separately.
+ */
+class kanavi_image
+{
+private:
+	/* data */
+	std::string unit_;
+	float scale_;	// counts per meter
+	int height_;	// channels
+	int width_;		// beams
+
+public:
+/**
+ * @brief Constructor for kanavi_image.
+ * @param unit Pixel unit (KANAVI::IMAGE::UNIT_CM or UNIT_MM).
+ * @param channels Image height.
+ * @param beams Image width.
+ */
+	kanavi_image(const std::string &unit, int channels, int beams);
+	~kanavi_image();
+
+/**
+ * @brief Returns the image height (channels).
+ */
+	int getHeight() const { return height_; }
+
+/**
+ * @brief Returns the image width (beams).
+ */
+	int getWidth() const { return width_; }
+
+/**
+ * @brief Returns the row size [byte].
+ */
+	uint32_t getStep() const { return static_cast<uint32_t>(width_) * sizeof(uint16_t); }
+
+/**
+ * @brief Returns the pixel unit name.
+ */
+	const std::string &getUnit() const { return unit_; }
+
+/**
+ * @brief Writes a whole frame (little endian).
+ * @param dst Destination, at least getHeight() * getStep() bytes.
+ * @param len_buf Range rows [m] per channel, missing beams are NO_RETURN.
+ */
+	void write(uint8_t *dst, const std::vector<std::vector<float>> &len_buf) const;
+};
+
+#endif // __KANAVI_IMAGE_H__
@@ -19,8 +19,10 @@
  * 
  */
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
+#include <stdexcept>
 #include "common.h"
 #include "r2_spec.h"
 #include "r4_spec.h"
@@ -47,7 +49,6 @@ typedef struct kanavi_datagram{
 	std::vector< std::vector<float> > len_buf;
 	// raw data size
 	size_t input_packet_size;
-<<<<<<< HEAD
 	kanavi_datagram() : model(-1), v_fov(0), v_resolution(0), h_fov(0), h_resolution(0),
 		checked_end(false), input_packet_size(0){
 	}
@@ -90,42 +91,6 @@ typedef struct kanavi_datagram{
 		} catch (const std::exception& e) {
 			printf("[LiDAR] Error in kanaviDatagram constructor: %s\n", e.what());
 			throw;
-=======
-
-	kanavi_datagram(){
-	}
-	kanavi_datagram(int model_){
-		model = model_;
-		switch(model)
-		{
-		case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-			v_fov = KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_FoV;
-			v_resolution = KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_RESOLUTION;
-			h_fov = KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_FoV;
-			h_resolution = KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION;
-			input_packet_size = KANAVI::COMMON::SPECIFICATION::R2::RAW_TOTAL_SIZE;
-			raw_buf.resize(KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL);
-			len_buf.resize(KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL);
-			break;
-		case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-			v_fov = KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_FoV;
-			v_resolution = KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION;
-			h_fov = KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_FoV;
-			h_resolution = KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION;
-			input_packet_size = KANAVI::COMMON::SPECIFICATION::R4::RAW_TOTAL_SIZE;
-			raw_buf.resize(KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL);
-			len_buf.resize(KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL);
-			break;
-		case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
-			v_fov = KANAVI::COMMON::SPECIFICATION::R270::VERTICAL_FoV;
-			v_resolution = KANAVI::COMMON::SPECIFICATION::R270::VERTICAL_RESOLUTION;
-			h_fov = KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_FoV;
-			h_resolution = KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION;
-			input_packet_size = KANAVI::COMMON::SPECIFICATION::R270::RAW_TOTAL_SIZE;
-			raw_buf.resize(KANAVI::COMMON::SPECIFICATION::R270::VERTICAL_CHANNEL);
-			len_buf.resize(KANAVI::COMMON::SPECIFICATION::R270::VERTICAL_CHANNEL);
-			break;
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
 		}
 	}
 
@@ -142,8 +107,47 @@ namespace KANAVI
 			const int SUCCESS = 1;
 		} // namespace InputMode
 	}
+
+	namespace STATUS
+	{
+		// detection byte of a distance packet, ref KANAVI::COMMON::PROTOCOL_VALUE::DATA::RESPONSE::DETECTION
+		const uint8_t AREA_SET = 1 << 0;
+		const uint8_t OUTPUT_PIN1 = 1 << 1;
+		const uint8_t OUTPUT_PIN2 = 1 << 2;
+		const uint8_t AREA_DETECT1 = 1 << 3;
+		const uint8_t AREA_DETECT2 = 1 << 4;
+		const uint8_t AREA_DETECT3 = 1 << 5;
+		const uint8_t AREA_DETECT4 = 1 << 6;
+		const uint8_t AREA_DETECT5 = 1 << 7;
+
+		// flags
+		const uint8_t DETECTION_VALID = 1 << 0;		// a distance packet was decoded
+		const uint8_t AREA_CONFIG_VALID = 1 << 1;	// an EXIST_AREA_CONFIG response was decoded
+
+		// EXIST_AREA_CONFIG response, OUTPUT_CHANNEL ~ QUANTITY_AREA in protocol order
+		// (ref KANAVI::COMMON::PROTOCOL_POS::RESPONSE::EXIST_AREA_CONFIG), config responses
+		// carry their data right after the command like the other PROTOCOL_POS::RESPONSE values
+		const int AREA_CONFIG_START = 5;
+		const int AREA_CONFIG_SIZE = KANAVI::COMMON::PROTOCOL_POS::RESPONSE::EXIST_AREA_CONFIG::QUANTITY_AREA + 1;
+	}
 }
 
+/**
+ * @brief sensor side status, decoded in the parse pass without touching the ranges
+ *
+ * Published as one byte array : [0] detection, [1] flags, [2 ~] area_config.
+ */
+typedef struct kanavi_status{
+	// KANAVI::STATUS::AREA_SET ~ AREA_DETECT5 of the last distance packet
+	uint8_t detection;
+	// KANAVI::STATUS::DETECTION_VALID | AREA_CONFIG_VALID
+	uint8_t flags;
+	// raw EXIST_AREA_CONFIG fields (angles are 2 bytes, high byte first)
+	uint8_t area_config[KANAVI::STATUS::AREA_CONFIG_SIZE];
+	kanavi_status() : detection(0), flags(0), area_config() {
+	}
+}kanaviStatus;
+
 /**
  * @class kanavi_lidar
  * @brief Handles LiDAR data parsing and processing for different Kanavi LiDAR models (R2, R4, R270).
@@ -172,29 +176,53 @@ private:
 
 /**
  * @brief Parses R2-model LiDAR data into structured format.
- * @param input Raw input data.
+ * @param input Raw input data (one packet, not copied).
+ * @param size Size of the packet.
  * @param output Output structure to hold parsed data.
  */
-	void r2(const std::vector<u_char> &input, kanaviDatagram *output);
+	void r2(const u_char *input, size_t size, kanaviDatagram *output);
 /**
  * @brief Parses R4-model LiDAR data into structured format.
- * @param input Raw input data.
+ * @param input Raw input data (one packet, not copied).
+ * @param size Size of the packet.
  * @param output Output structure to hold parsed data.
  */
-	void r4(const std::vector<u_char> &input, kanaviDatagram *output);
+	void r4(const u_char *input, size_t size, kanaviDatagram *output);
 /**
  * @brief Parses R270-model LiDAR data into structured format.
- * @param input Raw input data.
+ * @param input Raw input data (one packet, not copied).
+ * @param size Size of the packet.
  * @param output Output structure to hold parsed data.
  */
-	void r270(const std::vector<u_char> &input, kanaviDatagram *output);
+	void r270(const u_char *input, size_t size, kanaviDatagram *output);
+/**
+ * @brief Decodes the newest complete channel chunk of a multi-channel(R2, R4) frame.
+ * @param data Frame buffer accumulated since channel 0.
+ * @param chunk_size Raw size of a single channel packet.
+ */
+	void parseChunk(const std::vector<u_char> &data, size_t chunk_size);
+
 /**
  * @brief Parses the length section of the data for a given channel.
- * @param input Raw input data.
+ * @param input Raw input data (one packet).
+ * @param size Size of the packet.
  * @param output Output datagram structure.
  * @param ch Channel index to parse.
  */
-	void parseLength(const std::vector<u_char> &input, kanaviDatagram *output, int ch);
+	void parseLength(const u_char *input, size_t size, kanaviDatagram *output, int ch);
+
+/**
+ * @brief Decodes the detection byte of a distance packet into the status.
+ * @param input Raw input data (one distance packet).
+ * @param size Size of the packet.
+ */
+	void parseDetection(const u_char *input, size_t size);
+
+/**
+ * @brief Decodes an EXIST_AREA_CONFIG response into the status.
+ * @param input Raw input data (one config response).
+ */
+	void parseAreaConfig(const std::vector<u_char> &input);
 	// !FUNTCIONS---
 
 	/* data */
@@ -209,6 +237,14 @@ private:
 	bool checked_ch0_inputed;
 	size_t total_size;
 
+	// per-channel streaming
+	bool checked_channel_end;
+	int last_channel;
+
+	// sensor status
+	kanaviStatus status_;
+	bool checked_status_changed;
+
 public:
 /**
  * @brief Constructor for kanavi_lidar class with specific model.
@@ -236,11 +272,41 @@ public:
  */
 	bool checkedProcessEnd();
 
+/**
+ * @brief Checks whether the last processed packet completed a channel.
+ * @return true if a channel was decoded by the last call to process().
+ */
+	bool checkedChannelEnd();
+
+/**
+ * @brief Returns the channel index decoded by the last call to process().
+ * @return Channel index (0 ~ VERTICAL_CHANNEL-1), or -1 if none.
+ */
+	int getLastChannel();
+
 /**
  * @brief Retrieves the parsed datagram result.
  * @return Parsed LiDAR data in kanaviDatagram format.
  */
-	kanaviDatagram getDatagram();
+	const kanaviDatagram &getDatagram();
+
+/**
+ * @brief Retrieves the parsed datagram result for in-place frame filters.
+ * @return Parsed LiDAR data in kanaviDatagram format, valid until the next frame.
+ */
+	kanaviDatagram &getMutableDatagram();
+
+/**
+ * @brief Checks whether the last processed packet changed the sensor status.
+ * @return true if the detection bits or the area configuration changed.
+ */
+	bool checkedStatusChanged();
+
+/**
+ * @brief Retrieves the sensor status (detection bits & area configuration).
+ * @return Status decoded from the last packets.
+ */
+	const kanaviStatus &getStatus();
 
 };
 
@@ -0,0 +1,269 @@
+#ifndef __KANAVI_LOG_H__
+#define __KANAVI_LOG_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_log.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief asynchronous, low-overhead logging for the receive/parse hot path
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Log calls only copy the format pointer and the arguments into a lock-free
+ * ring; formatting and stdout writes happen on a background thread.
+ * Levels below KANAVI_LOG_LEVEL are removed at compile time.
+ *
+ * ex)	KANAVI_LOG_DEBUG("[LiDAR] channel %d decoded\n", ch);
+ * 		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid header\n");
+ *
+ * The format string must be a literal (it is formatted later). String
+ * arguments are copied, up to KANAVI::LOG::TEXT_SIZE bytes per record.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#define KANAVI_LOG_LEVEL_DEBUG	0
+#define KANAVI_LOG_LEVEL_INFO	1
+#define KANAVI_LOG_LEVEL_WARN	2
+#define KANAVI_LOG_LEVEL_ERROR	3
+#define KANAVI_LOG_LEVEL_NONE	4
+
+// set by CMake (-DKANAVI_LOG_LEVEL=...)
+#ifndef KANAVI_LOG_LEVEL
+#define KANAVI_LOG_LEVEL KANAVI_LOG_LEVEL_INFO
+#endif
+
+namespace KANAVI
+{
+	namespace LOG
+	{
+		enum LEVEL
+		{
+			LEVEL_DEBUG = KANAVI_LOG_LEVEL_DEBUG,
+			LEVEL_INFO = KANAVI_LOG_LEVEL_INFO,
+			LEVEL_WARN = KANAVI_LOG_LEVEL_WARN,
+			LEVEL_ERROR = KANAVI_LOG_LEVEL_ERROR
+		};
+
+		const int MAX_ARGS = 8;
+		const int TEXT_SIZE = 64;
+		const size_t RING_SIZE = 4096;	// must be power of 2
+
+		enum ARG_TYPE
+		{
+			ARG_INT = 0,
+			ARG_UINT = 1,
+			ARG_DOUBLE = 2,
+			ARG_TEXT = 3,
+			ARG_POINTER = 4
+		};
+
+		/**
+		 * @brief binary log entry, formatted later by the drain thread
+		 */
+		struct record
+		{
+			const char *fmt;
+			uint8_t level;
+			uint8_t argc;
+			uint8_t text_used;
+			uint8_t types[MAX_ARGS];
+			union
+			{
+				int64_t i;
+				uint64_t u;
+				double f;
+				const void *p;
+				uint32_t text;	// offset in text[]
+			} args[MAX_ARGS];
+			char text[TEXT_SIZE];
+		};
+
+		/**
+		 * @brief pushes a record into the ring (never blocks, drops when full)
+		 * @param rec record to push
+		 */
+		void push(const record &rec);
+
+		/**
+		 * @brief blocks until every pushed record has been written
+		 */
+		void flush();
+
+		/**
+		 * @brief monotonic clock in milliseconds, used by the throttle macros
+		 */
+		inline int64_t nowMs()
+		{
+			return std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		//SECTION - argument encoding
+		inline void putArg(record &r, const char *v)
+		{
+			r.types[r.argc] = ARG_TEXT;
+			r.args[r.argc].text = r.text_used;
+			if (v == nullptr)
+			{
+				v = "(null)";
+			}
+			// last byte is kept as terminator, long texts are truncated
+			size_t len = strnlen(v, TEXT_SIZE - 1 - r.text_used);
+			memcpy(r.text + r.text_used, v, len);
+			r.text_used = static_cast<uint8_t>(r.text_used + len);
+			r.text[r.text_used] = '\0';
+			if (r.text_used < TEXT_SIZE - 1)
+			{
+				r.text_used++;
+			}
+		}
+
+		inline void putArg(record &r, char *v)
+		{
+			putArg(r, static_cast<const char *>(v));
+		}
+
+		inline void putArg(record &r, const std::string &v)
+		{
+			putArg(r, v.c_str());
+		}
+
+		template <typename T>
+		inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+		putArg(record &r, T v)
+		{
+			r.types[r.argc] = ARG_INT;
+			r.args[r.argc].i = static_cast<int64_t>(v);
+		}
+
+		template <typename T>
+		inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+		putArg(record &r, T v)
+		{
+			r.types[r.argc] = ARG_UINT;
+			r.args[r.argc].u = static_cast<uint64_t>(v);
+		}
+
+		template <typename T>
+		inline typename std::enable_if<std::is_enum<T>::value>::type
+		putArg(record &r, T v)
+		{
+			r.types[r.argc] = ARG_INT;
+			r.args[r.argc].i = static_cast<int64_t>(v);
+		}
+
+		template <typename T>
+		inline typename std::enable_if<std::is_floating_point<T>::value>::type
+		putArg(record &r, T v)
+		{
+			r.types[r.argc] = ARG_DOUBLE;
+			r.args[r.argc].f = static_cast<double>(v);
+		}
+
+		template <typename T>
+		inline void putArg(record &r, const T *v)
+		{
+			r.types[r.argc] = ARG_POINTER;
+			r.args[r.argc].p = static_cast<const void *>(v);
+		}
+
+		inline void encode(record &)
+		{
+		}
+
+		template <typename T, typename... ARGS>
+		inline void encode(record &r, const T &v, const ARGS &... rest)
+		{
+			if (r.argc >= MAX_ARGS)
+			{
+				return;
+			}
+			putArg(r, v);
+			r.argc++;
+			encode(r, rest...);
+		}
+		//!SECTION
+
+		/**
+		 * @brief captures a log call into a record and pushes it
+		 * @param level log level
+		 * @param fmt printf-style format literal
+		 * @param args format arguments
+		 */
+		template <typename... ARGS>
+		inline void write(LEVEL level, const char *fmt, const ARGS &... args)
+		{
+			record r;
+			r.fmt = fmt;
+			r.level = static_cast<uint8_t>(level);
+			r.argc = 0;
+			r.text_used = 0;
+			encode(r, args...);
+			push(r);
+		}
+	} // namespace LOG
+} // namespace KANAVI
+
+#define KANAVI_LOG_THROTTLE_(level, period_ms, ...)                                                     \
+	do                                                                                                  \
+	{                                                                                                   \
+		static std::atomic<int64_t> kanavi_log_last_(-(period_ms));                                     \
+		int64_t kanavi_log_now_ = KANAVI::LOG::nowMs();                                                 \
+		int64_t kanavi_log_prev_ = kanavi_log_last_.load(std::memory_order_relaxed);                    \
+		if (kanavi_log_now_ - kanavi_log_prev_ >= (period_ms) &&                                        \
+			kanavi_log_last_.compare_exchange_strong(kanavi_log_prev_, kanavi_log_now_,                 \
+													 std::memory_order_relaxed))                        \
+		{                                                                                               \
+			KANAVI::LOG::write(level, __VA_ARGS__);                                                     \
+		}                                                                                               \
+	} while (0)
+
+#define KANAVI_LOG_DISABLED_(...) do {} while (0)
+
+#if KANAVI_LOG_LEVEL <= KANAVI_LOG_LEVEL_DEBUG
+#define KANAVI_LOG_DEBUG(...) KANAVI::LOG::write(KANAVI::LOG::LEVEL_DEBUG, __VA_ARGS__)
+#define KANAVI_LOG_DEBUG_THROTTLE(period_ms, ...) KANAVI_LOG_THROTTLE_(KANAVI::LOG::LEVEL_DEBUG, period_ms, __VA_ARGS__)
+#else
+#define KANAVI_LOG_DEBUG(...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#define KANAVI_LOG_DEBUG_THROTTLE(period_ms, ...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if KANAVI_LOG_LEVEL <= KANAVI_LOG_LEVEL_INFO
+#define KANAVI_LOG_INFO(...) KANAVI::LOG::write(KANAVI::LOG::LEVEL_INFO, __VA_ARGS__)
+#define KANAVI_LOG_INFO_THROTTLE(period_ms, ...) KANAVI_LOG_THROTTLE_(KANAVI::LOG::LEVEL_INFO, period_ms, __VA_ARGS__)
+#else
+#define KANAVI_LOG_INFO(...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#define KANAVI_LOG_INFO_THROTTLE(period_ms, ...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if KANAVI_LOG_LEVEL <= KANAVI_LOG_LEVEL_WARN
+#define KANAVI_LOG_WARN(...) KANAVI::LOG::write(KANAVI::LOG::LEVEL_WARN, __VA_ARGS__)
+#define KANAVI_LOG_WARN_THROTTLE(period_ms, ...) KANAVI_LOG_THROTTLE_(KANAVI::LOG::LEVEL_WARN, period_ms, __VA_ARGS__)
+#else
+#define KANAVI_LOG_WARN(...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#define KANAVI_LOG_WARN_THROTTLE(period_ms, ...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if KANAVI_LOG_LEVEL <= KANAVI_LOG_LEVEL_ERROR
+#define KANAVI_LOG_ERROR(...) KANAVI::LOG::write(KANAVI::LOG::LEVEL_ERROR, __VA_ARGS__)
+#define KANAVI_LOG_ERROR_THROTTLE(period_ms, ...) KANAVI_LOG_THROTTLE_(KANAVI::LOG::LEVEL_ERROR, period_ms, __VA_ARGS__)
+#else
+#define KANAVI_LOG_ERROR(...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#define KANAVI_LOG_ERROR_THROTTLE(period_ms, ...) KANAVI_LOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#endif // __KANAVI_LOG_H__
@@ -0,0 +1,103 @@
+#ifndef __KANAVI_PALETTE_H__
+#define __KANAVI_PALETTE_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_palette.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief range -> RGB lookup table for point coloring
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace PALETTE
+	{
+		const std::string HSV	= "hsv";	// hue wheel, repeats every color range
+		const std::string GRAY	= "gray";	// black -> white, clamped at color range
+		const std::string NONE	= "none";	// no coloring
+
+		const float DEFAULT_RANGE = 18.0;	// [m], legacy hue = len * 20 [deg]
+		const float MAX_RANGE = 260.0;		// [m], 2 byte length tops out at 255 + 2.55
+		const int RESOLUTION = 100;			// LUT entries per meter (1 cm)
+	}
+}
+
+/**
+ * @class kanavi_palette
+ * @brief Precomputed color per centimetre of range.
+ *
+ * The table is built once for the selected palette and range mapping, so
+ * coloring a point is one multiply and one load instead of an HSV conversion.
+ */
+class kanavi_palette
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Fills the table from the palette name and range mapping.
+ */
+	void build();
+	// !FUNTCIONS---
+
+	/* data */
+	std::string name_;
+	float range_;		// [m], distance covered by one palette span
+	bool enabled_;
+
+	// index = range [cm], packed as 0x00RRGGBB
+	std::vector<uint32_t> table_;
+
+public:
+/**
+ * @brief Constructor for kanavi_palette.
+ * @param name Palette name (KANAVI::PALETTE::HSV, GRAY or NONE).
+ * @param range Distance mapped onto one palette span [m].
+ */
+	kanavi_palette(const std::string &name, float range);
+	~kanavi_palette();
+
+/**
+ * @brief Returns false when coloring is switched off.
+ */
+	bool isEnabled() const { return enabled_; }
+
+/**
+ * @brief Returns the packed color (0x00RRGGBB) of a range.
+ * @param len Distance measurement [m].
+ */
+	uint32_t color(float len) const
+	{
+		int idx = static_cast<int>(len * KANAVI::PALETTE::RESOLUTION);
+		if (idx < 0)
+		{
+			idx = 0;
+		}
+		else if (idx >= static_cast<int>(table_.size()))
+		{
+			idx = static_cast<int>(table_.size()) - 1;
+		}
+		return table_[idx];
+	}
+
+/**
+ * @brief Returns the palette name in use.
+ */
+	const std::string &getName() const { return name_; }
+};
+
+#endif // __KANAVI_PALETTE_H__
@@ -0,0 +1,197 @@
+#ifndef __KANAVI_PROJECTION_H__
+#define __KANAVI_PROJECTION_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_projection.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief precomputed beam direction tables for range -> XYZ projection
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <vector>
+#include "common.h"
+#include "kanavi_calibration.h"
+
+/**
+ * @class kanavi_projection
+ * @brief Holds a unit direction vector for every (channel, beam) of a LiDAR model.
+ *
+ * The table is built once at startup with the base rotation (BASE_ZERO_ANGLE),
+ * the intrinsic calibration and the mounting rotation already applied, so a
+ * point is just range * direction on each axis, plus an offset row when there
+ * is a range offset or a mounting translation. Points come out in the output
+ * (vehicle) frame without any further transform.
+ * Directions are stored channel-major, one contiguous row per channel.
+ * project() runs a whole channel through a SIMD kernel (AVX2 / SSE / scalar)
+ * selected once at runtime for the CPU it runs on.
+ */
+class kanavi_projection
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Rebuilds the direction table from the model specification and the calibration.
+ */
+	void build();
+	// !FUNTCIONS---
+
+	// range row * direction rows -> x, y, z rows
+	typedef void (*kernel_t)(const float *len, const float *dx, const float *dy, const float *dz,
+							 int count, float *x, float *y, float *z);
+
+	// range row * direction rows + offset rows -> x, y, z rows
+	typedef void (*offset_kernel_t)(const float *len, const float *dx, const float *dy, const float *dz,
+									const float *ox, const float *oy, const float *oz,
+									int count, float *x, float *y, float *z);
+
+	/* data */
+	kernel_t kernel_;
+	offset_kernel_t offset_kernel_;
+	const char *kernel_name_;
+	bool has_offset_;
+
+	KANAVI::CALIBRATION::intrinsic calib_;
+	KANAVI::CALIBRATION::extrinsic pose_;
+
+	int model_;
+	int channels_;
+	int beams_;
+	double v_resolution_;	// [deg]
+	double h_resolution_;	// [deg]
+	float base_angle_;		// [deg], rotation around Z
+
+	// beam angles [deg], elevation per channel, azimuth per beam (base rotation included)
+	std::vector<float> elevation_;
+	std::vector<float> azimuth_;
+
+	// direction (rotated unit * range scale), index = ch * beams_ + beam
+	std::vector<float> dx_;
+	std::vector<float> dy_;
+	std::vector<float> dz_;
+
+	// range offset * rotated unit + translation, empty without both
+	std::vector<float> ox_;
+	std::vector<float> oy_;
+	std::vector<float> oz_;
+
+public:
+/**
+ * @brief Constructor for kanavi_projection with specific model.
+ * @param model LiDAR model identifier (e.g., R2, R4, R270), ref include/common.h
+ * @param base_angle Rotation around Z applied to every direction [deg].
+ * @param calib Intrinsic correction of the sensor, empty = specification.
+ * @param pose Mounting pose of the sensor in the output frame, default = identity.
+ * @throws std::runtime_error on an invalid model or calibration size.
+ */
+	kanavi_projection(int model, float base_angle,
+					  const KANAVI::CALIBRATION::intrinsic &calib = KANAVI::CALIBRATION::intrinsic(),
+					  const KANAVI::CALIBRATION::extrinsic &pose = KANAVI::CALIBRATION::extrinsic());
+	~kanavi_projection();
+
+/**
+ * @brief Returns the LiDAR model identifier.
+ */
+	int getModel() const { return model_; }
+
+/**
+ * @brief Returns the base rotation around Z [deg].
+ */
+	float getBaseAngle() const { return base_angle_; }
+
+/**
+ * @brief Returns the mounting pose folded into the table.
+ */
+	const KANAVI::CALIBRATION::extrinsic &getPose() const { return pose_; }
+
+/**
+ * @brief Returns the number of vertical channels of the model.
+ */
+	int getChannels() const { return channels_; }
+
+/**
+ * @brief Returns the number of horizontal beams per channel.
+ */
+	int getBeams() const { return beams_; }
+
+/**
+ * @brief Returns the horizontal angle between two beams [deg].
+ */
+	double getHorizontalResolution() const { return h_resolution_; }
+
+/**
+ * @brief Returns the elevation of a channel in the sensor frame [deg], calibration included.
+ * @param ch Channel index.
+ */
+	float getElevation(int ch) const { return elevation_[ch]; }
+
+/**
+ * @brief Returns the azimuth of a beam in the sensor frame [deg], base rotation and calibration included.
+ * @param beam Beam index.
+ */
+	float getAzimuth(int beam) const { return azimuth_[beam]; }
+
+/**
+ * @brief Projects one channel of ranges to XYZ (structure of arrays).
+ * @param len Range row of the channel [m].
+ * @param ch Channel index.
+ * @param count Number of beams to project (<= getBeams()).
+ * @param x Output X row (count elements).
+ * @param y Output Y row (count elements).
+ * @param z Output Z row (count elements).
+ */
+	void project(const float *len, int ch, int count, float *x, float *y, float *z) const;
+
+/**
+ * @brief Returns the name of the kernel selected for this CPU (e.g. "avx2").
+ */
+	const char *getKernelName() const { return kernel_name_; }
+
+/**
+ * @brief Returns the X direction row of a channel.
+ * @param ch Channel index.
+ */
+	const float *dirX(int ch) const { return dx_.data() + ch * beams_; }
+
+/**
+ * @brief Returns the Y direction row of a channel.
+ * @param ch Channel index.
+ */
+	const float *dirY(int ch) const { return dy_.data() + ch * beams_; }
+
+/**
+ * @brief Returns the Z direction row of a channel.
+ * @param ch Channel index.
+ */
+	const float *dirZ(int ch) const { return dz_.data() + ch * beams_; }
+
+/**
+ * @brief Returns the X offset row of a channel, nullptr without offset.
+ * @param ch Channel index.
+ */
+	const float *offsetX(int ch) const { return has_offset_ ? ox_.data() + ch * beams_ : nullptr; }
+
+/**
+ * @brief Returns the Y offset row of a channel, nullptr without offset.
+ * @param ch Channel index.
+ */
+	const float *offsetY(int ch) const { return has_offset_ ? oy_.data() + ch * beams_ : nullptr; }
+
+/**
+ * @brief Returns the Z offset row of a channel, nullptr without offset.
+ * @param ch Channel index.
+ */
+	const float *offsetZ(int ch) const { return has_offset_ ? oz_.data() + ch * beams_ : nullptr; }
+};
+
+#endif // __KANAVI_PROJECTION_H__
@@ -0,0 +1,94 @@
+#ifndef __KANAVI_SCAN_H__
+#define __KANAVI_SCAN_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_scan.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief LaserScan geometry and range row writer
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "kanavi_projection.h"
+
+namespace KANAVI
+{
+	namespace SCAN
+	{
+		const float RANGE_MIN = 0.01;	// [m]
+		const float RANGE_MAX = 257.55;	// [m], largest 2 byte length (255 + 255 / 100)
+		const float MAX_DEVIATION = 0.01;	// [deg], larger per-beam azimuth offsets are reported
+	}
+}
+
+/**
+ * @class kanavi_scan
+ * @brief Holds the sensor_msgs/LaserScan angles of one ring and fills its ranges.
+ *
+ * LaserScan angles are uniform : the first and last calibrated beam azimuths
+ * define angle_min and angle_increment, per-beam azimuth offsets in between
+ * can not be represented (getMaxDeviation()). Beams without return are
+ * written as +Inf (REP 117).
+ */
+class kanavi_scan
+{
+private:
+	/* data */
+	float angle_min_;		// [rad]
+	float angle_increment_;	// [rad]
+	int beams_;
+	float max_deviation_;	// calibrated azimuth vs uniform angle [deg]
+
+public:
+/**
+ * @brief Constructor for kanavi_scan, rebuilt with the projection.
+ * @param projection Beam azimuths, base rotation and calibration included.
+ */
+	explicit kanavi_scan(const kanavi_projection &projection);
+	~kanavi_scan();
+
+/**
+ * @brief Returns the azimuth of the first beam [rad].
+ */
+	float getAngleMin() const { return angle_min_; }
+
+/**
+ * @brief Returns the azimuth of the last beam [rad].
+ */
+	float getAngleMax() const { return angle_min_ + angle_increment_ * (beams_ - 1); }
+
+/**
+ * @brief Returns the angle between two beams [rad].
+ */
+	float getAngleIncrement() const { return angle_increment_; }
+
+/**
+ * @brief Returns the number of beams.
+ */
+	int getBeams() const { return beams_; }
+
+/**
+ * @brief Returns the largest gap between a calibrated beam azimuth and its LaserScan angle [deg].
+ */
+	float getMaxDeviation() const { return max_deviation_; }
+
+/**
+ * @brief Writes one ring of ranges.
+ * @param dst Destination, getBeams() floats.
+ * @param len Range row [m].
+ * @param count Number of ranges in len, missing beams are +Inf.
+ */
+	void write(float *dst, const float *len, int count) const;
+};
+
+#endif // __KANAVI_SCAN_H__
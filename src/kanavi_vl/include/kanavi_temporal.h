@@ -0,0 +1,136 @@
+#ifndef __KANAVI_TEMPORAL_H__
+#define __KANAVI_TEMPORAL_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_temporal.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief per-beam temporal noise filter over the last frames
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace TEMPORAL
+	{
+		const std::string MEDIAN		= "median";			// median of the last frames (3 or 5)
+		const std::string PERSISTENCE	= "persistence";	// return seen in every one of the last frames
+
+		enum MODE
+		{
+			MODE_MEDIAN = 0,
+			MODE_PERSISTENCE = 1
+		};
+
+		const int DEFAULT_FRAMES = 3;
+		const int MAX_FRAMES = 8;
+		const float DEFAULT_TOLERANCE = 0.1f;	// [m], persistence range agreement
+	}
+}
+
+/**
+ * @class kanavi_temporal
+ * @brief Filters every (channel, beam) range over a ring of the last frames.
+ *
+ * The history is a fixed ring of int16 range grids in cm, which is exactly
+ * the resolution of the protocol (1 m + 1 cm bytes), so nothing is lost and
+ * a frame of history is 2 bytes per beam. Both kernels are branchless
+ * min / max / compare loops over a contiguous row that the compiler
+ * vectorizes (pminsw / pmaxsw on plain SSE2).
+ *
+ * median      : range of a beam = median of its last 3 or 5 frames, a single
+ *               frame spike or dropout is replaced, at (frames - 1) / 2 frames lag.
+ * persistence : a return is kept only if the beam saw a return within the
+ *               tolerance in each of the last frames, otherwise it becomes 0.
+ *
+ * Until the ring is full the frames pass through unchanged.
+ */
+class kanavi_temporal
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Writes the median of the ring into out.
+ */
+	void median(size_t row, int count, int16_t *out) const;
+
+/**
+ * @brief Zeroes the returns of out which did not persist over the ring.
+ */
+	void persistence(size_t row, int count, int16_t *out);
+	// !FUNTCIONS---
+
+	/* data */
+	KANAVI::TEMPORAL::MODE mode_;
+	std::string mode_name_;
+	int frames_;
+	int16_t tolerance_;		// [cm]
+
+	int channels_;
+	int beams_;
+
+	// frames_ grids of channels_ x beams_ ranges [cm], index = frame * grid + ch * beams_ + beam
+	std::vector<int16_t> ring_;
+	size_t grid_;
+	int head_;		// slot of the current frame
+	int filled_;	// frames in the ring
+
+	// one row of output / hit counts
+	std::vector<int16_t> out_;
+	std::vector<int16_t> hits_;
+
+public:
+/**
+ * @brief Constructor for kanavi_temporal.
+ * @param mode KANAVI::TEMPORAL::MEDIAN or KANAVI::TEMPORAL::PERSISTENCE.
+ * @param frames Number of frames in the ring (median : 3 or 5, persistence : 2 ~ MAX_FRAMES).
+ * @param tolerance Range agreement of the persistence check [m].
+ * @param channels Number of channels of the grid.
+ * @param beams Number of beams per channel.
+ * @throws std::runtime_error on an invalid mode or frame count.
+ */
+	kanavi_temporal(const std::string &mode, int frames, float tolerance, int channels, int beams);
+	~kanavi_temporal();
+
+/**
+ * @brief Pushes one frame into the ring and filters its ranges in place.
+ * @param len_buf Range rows of the frame [m], one per channel.
+ */
+	void filter(std::vector< std::vector<float> > &len_buf);
+
+/**
+ * @brief Drops the history, the next frames pass through until the ring is full.
+ */
+	void reset();
+
+/**
+ * @brief Returns the mode name.
+ */
+	const std::string &getMode() const { return mode_name_; }
+
+/**
+ * @brief Returns the number of frames in the ring.
+ */
+	int getFrames() const { return frames_; }
+
+/**
+ * @brief Returns the persistence tolerance [m].
+ */
+	float getTolerance() const { return tolerance_ * 0.01f; }
+};
+
+#endif // __KANAVI_TEMPORAL_H__
@@ -20,17 +20,23 @@
  */
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <boost/make_shared.hpp>
 #include <iostream>
-#include <pcl/point_cloud.h>
-#include <pcl_ros/point_cloud.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/PCLPointCloud2.h>
-#include <pcl/conversions.h>
-#include <pcl/common/angles.h>
-#include <pcl/common/transforms.h>
-#include <pcl/point_types.h>
-#include <pcl/pcl_macros.h>
-
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/PointField.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/image_encodings.h>
+#include <sensor_msgs/LaserScan.h>
+#include <std_msgs/Float32MultiArray.h>
+#include <std_msgs/Bool.h>
+#include <std_msgs/UInt8MultiArray.h>
+#include <nav_msgs/Odometry.h>
+#include <tf2_ros/transform_listener.h>
+#include <tf2/LinearMath/Quaternion.h>
+#include <tf2/LinearMath/Matrix3x3.h>
+
+#include <atomic>
 #include <chrono>
 #include <string>
 
@@ -39,9 +45,20 @@
 #include "udp.h"
 
 #include <kanavi_lidar.h>	// for LiDAR data processing
-
-typedef pcl::PointXYZRGB PointT;
-typedef pcl::PointCloud<PointT> PointCloudT;
+#include <kanavi_projection.h>	// for beam direction tables
+#include <kanavi_palette.h>	// for range coloring
+#include <kanavi_cloud.h>	// for PointCloud2 layout & writer
+#include <kanavi_image.h>	// for 16-bit range image
+#include <kanavi_scan.h>	// for LaserScan
+#include <kanavi_calibration.h>	// for intrinsic calibration
+#include <kanavi_crop.h>	// for range / angle / box crop
+#include <kanavi_voxel.h>	// for voxel grid downsampling
+#include <kanavi_temporal.h>	// for temporal noise filter
+#include <kanavi_background.h>	// for background model
+#include <kanavi_codec.h>	// for delta encoded frames
+#include <kanavi_zone.h>	// for intrusion zones
+#include <kanavi_cluster.h>	// for scan-order clustering
+#include <kanavi_accumulate.h>	// for sliding window accumulation
 
 using namespace std::chrono_literals;  // "10ms"와 같은 단위 사용을 위해 필요
 
@@ -58,6 +75,14 @@ private:
 
 	//SECTION - FUNCS.
 
+/**
+ * @brief Parses the arguments and sets up UDP, processing and publishers (shared by both constructors).
+ * @param node_ Model name (r2, r4, r270).
+ * @param argc_ Argument count.
+ * @param argv_ Argument values.
+ */
+	void initialize(const std::string &node_, int &argc_, char **argv_);
+
 /**
  * @brief Prints help message for ROS1 node command-line usage.
  */
@@ -79,10 +104,10 @@ private:
 	void log_set_parameters();
 
 /**
- * @brief Converts raw datagram into an internal point cloud representation.
+ * @brief Converts raw datagram into the reused PointCloud2 message.
  * @param datagram Parsed datagram from LiDAR sensor.
  */
-	void length2PointCloud(kanaviDatagram datagram);
+	void length2PointCloud(const kanaviDatagram &datagram);
 
 /**
  * @brief Calculates angular resolution and spacing for a specific LiDAR model.
@@ -91,52 +116,149 @@ private:
 	void calculateAngular(int model);
 
 /**
- * @brief Converts a kanaviDatagram into a PCL-compatible point cloud.
+ * @brief Writes a whole kanaviDatagram into a PointCloud2 message.
  * @param datagram Parsed kanaviDatagram.
- * @param cloud_ Output point cloud.
+ * @param msg Output message (data buffer is reused).
  */
-	void generatePointCloud(const kanaviDatagram &datagram, PointCloudT &cloud_);
+	void generatePointCloud(const kanaviDatagram &datagram, sensor_msgs::PointCloud2 &msg);
 
 /**
- * @brief Converts a length measurement and trigonometric values to a 3D point.
- * @param len Distance measurement.
- * @param v_sin Vertical sine.
- * @param v_cos Vertical cosine.
- * @param h_sin Horizontal sine.
- * @param h_cos Horizontal cosine.
- * @return Computed 3D point(XYZRGB).
+ * @brief Masks and projects one channel into the scratch rows (g_proj_*, g_valid).
+ * @param datagram Parsed kanaviDatagram.
+ * @param ch Channel index.
+ * @return Number of beams projected, 0 if the channel has no data or is cropped.
  */
-	PointT length2point(float len, float v_sin, float v_cos, float h_sin, float h_cos);
+	size_t projectChannel(const kanaviDatagram &datagram, int ch);
 
 /**
- * @brief Converts HSV color to RGB color.
- * @param fR Pointer to resulting red value.
- * @param fG Pointer to resulting green value.
- * @param fB Pointer to resulting blue value.
- * @param fH Hue component.
- * @param fS Saturation component.
- * @param fV Value component.
+ * @brief Writes a single channel of a kanaviDatagram into a PointCloud2 message.
+ * @param datagram Parsed kanaviDatagram.
+ * @param ch Channel index.
+ * @param layout Layout writer of the message.
+ * @param msg Output message (data buffer is reused).
+ * @param offset First point index to write at.
+ * @return Number of points written.
  */
-	void HSV2RGB(float *fR, float *fG, float *fB, float fH, float fS, float fV);
-	
+	size_t generateChannelPointCloud(const kanaviDatagram &datagram, int ch, const kanavi_cloud &layout, sensor_msgs::PointCloud2 &msg, size_t offset);
+
 /**
- * @brief Converts a PCL point cloud to ROS1 PointCloud2 message format.
- * 
- * @param ww Width of the point cloud.
- * @param hh Height of the point cloud.
- * @param cloud Input point cloud (XYZRGB).
- * @param timestamp Time stamp to include in message.
- * @param frame Coordinate frame ID.
- * @return ROS1 PointCloud2 message.
+ * @brief Creates a layout writer, falls back to the default layout on an invalid name.
+ * @param layout Layout name (KANAVI::CLOUD::LAYOUT_*).
+ * @return Layout writer.
+ */
+	std::unique_ptr<kanavi_cloud> createLayout(const std::string &layout);
+
+/**
+ * @brief Sets the field layout of a message once and reserves its data buffer.
+ * @param msg Message to initialize.
+ * @param layout Layout writer of the message.
+ * @param points Expected number of points per publish.
+ */
+	void initCloudMsg(sensor_msgs::PointCloud2 &msg, const kanavi_cloud &layout, size_t points);
+
+/**
+ * @brief Sets width / height / row_step / data size after the points are written.
+ * @param msg Message to finish.
+ * @param width Points per row.
+ * @param height Number of rows (1 = unorganized).
+ */
+	void finishCloudMsg(sensor_msgs::PointCloud2 &msg, size_t width, size_t height = 1);
+
+/**
+ * @brief Publishes a single decoded channel without waiting for the whole frame.
+ * @param ch Channel index.
+ * @param stamp Arrival time of the channel packet.
+ */
+	void publishChannel(int ch, const ros::Time &stamp);
+
+/**
+ * @brief Publishes a reused cloud message, handed over as shared_ptr in a nodelet.
+ * @param publisher Target publisher.
+ * @param msg Reused message, its buffer is replaced by an empty one of the same capacity when handed over.
+ */
+	void publishCloud(ros::Publisher &publisher, sensor_msgs::PointCloud2 &msg);
+
+/**
+ * @brief Writes the decoded frame into the reused range image and publishes it.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishRangeImage(const ros::Time &stamp);
+
+/**
+ * @brief Publishes the static beam angles of the range image (latched).
  */
-	sensor_msgs::PointCloud2 cloud_to_cloud_msg(int ww, int hh, const pcl::PointCloud<pcl::PointXYZRGB>& cloud, int timestamp, const std::string& frame);
+	void publishBeamAngles();
 
 /**
- * @brief Rotates the point cloud around the Z-axis by a given angle.
- * @param cloud Input/output point cloud.
- * @param angle Rotation angle in radians.
+ * @brief Publishes the decoded frame as LaserScan, one message per ring.
+ * @param stamp Time stamp of the frame.
  */
-	void rotateAxisZ(PointCloudT::Ptr cloud, float angle);
+	void publishScan(const ros::Time &stamp);
+
+/**
+ * @brief Downsamples the decoded frame on the voxel grid and publishes it.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishVoxel(const ros::Time &stamp);
+
+/**
+ * @brief Learns the frame into the background and publishes the foreground beams & activity flag.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishForeground(const ros::Time &stamp);
+
+/**
+ * @brief Encodes the frame as a keyframe or a delta and publishes it.
+ */
+	void publishDelta();
+
+/**
+ * @brief Publishes the state of the zones changed by the last frame.
+ * @param all Publish every zone (startup).
+ */
+	void publishZones(bool all);
+
+/**
+ * @brief Publishes the sensor status (detection bits & area configuration).
+ */
+	void publishStatus();
+
+/**
+ * @brief Segments the frame along scan order and publishes the clusters.
+ */
+	void publishClusters();
+
+/**
+ * @brief Writes the frame over the oldest row of the window, publishes the window every decimation frames.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishAccumulated(const ros::Time &stamp);
+
+/**
+ * @brief Keeps the latest odometry pose for motion compensation.
+ * @param msg Odometry of the output frame.
+ */
+	void odometryCallback(const nav_msgs::Odometry::ConstPtr &msg);
+
+/**
+ * @brief Rebuilds the LaserScan angles from the current (calibrated) projection.
+ */
+	void updateScanAngles();
+
+/**
+ * @brief Rebuilds the projection when the sender or the calibration file changed.
+ *
+ * Polled once per KANAVI::CALIBRATION::RELOAD_PERIOD_MS, the current
+ * projection is kept when the new calibration is invalid.
+ */
+	void updateCalibration();
+
+/**
+ * @brief Looks up the static mounting pose (fixed frame <- sensor frame) once at startup.
+ *
+ * Keeps the -pose value when the transform is not available in time.
+ */
+	void lookupPose();
 
 	// need process...
 	
@@ -159,12 +281,85 @@ private:
 	ros::NodeHandle nh_;
 	ros::Publisher publisher_;
 
+	// nodelet : own callback queue served by the receive thread, nullptr = global queue
+	ros::CallbackQueue *queue_;
+	// nodelet : clouds handed over as shared_ptr, never modified after publishing
+	bool shared_publish_;
+	std::atomic<bool> running_;
+
 	// timer for RECV
 	ros::Timer timer_;
 
 	// flags
 	bool checked_multicast_;
 	bool checked_help_;
+	bool checked_stream_;
+	bool checked_organized_;
+	bool checked_scan_;
+
+	// coloring
+	std::string colorName_;
+	float colorRange_;
+
+	// PointCloud2 layouts
+	std::string layoutName_;
+	std::string streamLayoutName_;
+
+	// range image
+	std::string rangeImageUnit_;
+
+	// intrinsic calibration (hot-reloaded), keyed by sender IP
+	std::string calibPath_;
+	std::unique_ptr<kanavi_calibration> m_calibration;
+	std::string calibIP_;		// sender the projection was built for
+	int64_t g_calibcheck;		// last poll [ms]
+
+	// mounting pose folded into the projection, points are published in the fixed frame
+	KANAVI::CALIBRATION::extrinsic pose_;
+	std::string poseFrame_;
+	// range image & LaserScan are not posed, they carry the sensor frame
+	std::string sensorName_;
+
+	// crop, rebuilt with the projection
+	KANAVI::CROP::config crop_;
+	std::unique_ptr<kanavi_crop> m_crop;
+
+	// voxel grid settings
+	float voxelSize_;
+	std::string voxelPolicy_;
+
+	// temporal filter settings
+	std::string temporalMode_;
+	int temporalFrames_;
+	float temporalTolerance_;
+
+	// background model settings
+	bool checked_background_;
+	float backgroundTolerance_;
+	int backgroundFrames_;
+	int backgroundMinBeams_;
+
+	// delta frame settings
+	bool checked_delta_;
+	float deltaThreshold_;
+	int deltaInterval_;
+
+	// intrusion zone file
+	std::string zonePath_;
+
+	// sensor status output
+	bool checked_status_;
+
+	// clustering settings
+	bool checked_cluster_;
+	float clusterRangeJump_;
+	float clusterAngularGap_;
+	int clusterMinPoints_;
+
+	// sliding window settings
+	int accumulateFrames_;
+	int accumulateDecimation_;
+	std::string odomTopic_;
 
 	// UDP network
 	std::unique_ptr<kanavi_udp> m_udp;
@@ -172,14 +367,86 @@ private:
 	// LiDAR data processing Class
 	std::unique_ptr<kanavi_lidar> kanavi_;
 
-	// sin, cos value for calculate Angle
-	std::vector<float> v_sin;
-	std::vector<float> v_cos;
-	std::vector<float> h_sin;
-	std::vector<float> h_cos;
-
-	// pcl point cloud 
-	PointCloudT::Ptr g_pointcloud;
+	// beam direction table (base rotation & calibration included)
+	std::unique_ptr<kanavi_projection> m_projection;
+
+	// range -> color table
+	std::unique_ptr<kanavi_palette> m_palette;
+
+	// PointCloud2 layout & writer (frame / channel stream)
+	std::unique_ptr<kanavi_cloud> m_cloud;
+	std::unique_ptr<kanavi_cloud> m_channelcloud;
+
+	// SoA scratch rows filled by the projection kernel (one channel)
+	std::vector<float> g_proj_x;
+	std::vector<float> g_proj_y;
+	std::vector<float> g_proj_z;
+
+	// validity row, 0 = dropped (NaN point in an organized cloud)
+	std::vector<uint8_t> g_valid;
+
+	// reused messages, data buffers keep their capacity between frames
+	sensor_msgs::PointCloud2 g_cloudmsg;
+
+	// per-channel streaming
+	std::vector<ros::Publisher> channel_publishers_;
+	sensor_msgs::PointCloud2 g_channelmsg;
+
+	// range image output
+	std::unique_ptr<kanavi_image> m_image;
+	ros::Publisher image_publisher_;
+	ros::Publisher angle_publisher_;
+	sensor_msgs::Image g_imagemsg;
+
+	// per-beam temporal filter, runs on the range grid before any output
+	std::unique_ptr<kanavi_temporal> m_temporal;
+
+	// voxel grid output
+	std::unique_ptr<kanavi_voxel> m_voxel;
+	std::unique_ptr<kanavi_cloud> m_voxelcloud;
+	ros::Publisher voxel_publisher_;
+	sensor_msgs::PointCloud2 g_voxelmsg;
+
+	// learned background, foreground only output
+	std::unique_ptr<kanavi_background> m_background;
+	std::unique_ptr<kanavi_cloud> m_foregroundcloud;
+	ros::Publisher foreground_publisher_;
+	ros::Publisher activity_publisher_;
+	sensor_msgs::PointCloud2 g_foregroundmsg;
+	std_msgs::Bool g_activitymsg;
+	bool g_foregroundsent;	// last foreground cloud was not empty
+
+	// keyframe + delta encoded frames
+	std::unique_ptr<kanavi_delta_encoder> m_delta;
+	ros::Publisher delta_publisher_;
+	std_msgs::UInt8MultiArray g_deltamsg;
+
+	// intrusion zones, one latched Bool per zone
+	std::unique_ptr<kanavi_zone> m_zone;
+	std::vector<ros::Publisher> zone_publishers_;
+	std_msgs::Bool g_zonemsg;
+
+	// sensor status, latched, published when it changes
+	ros::Publisher status_publisher_;
+	std_msgs::UInt8MultiArray g_statusmsg;
+
+	// scan-order clusters, one row of KANAVI::CLUSTER::FIELDS per cluster
+	std::unique_ptr<kanavi_cluster> m_cluster;
+	ros::Publisher cluster_publisher_;
+	std_msgs::Float32MultiArray g_clustermsg;
+
+	// sliding window of the last frames, one organized row per frame
+	std::unique_ptr<kanavi_accumulate> m_accumulate;
+	std::unique_ptr<kanavi_cloud> m_acccloud;
+	ros::Publisher accumulate_publisher_;
+	ros::Subscriber odom_subscriber_;
+	sensor_msgs::PointCloud2 g_accmsg;
+
+	// LaserScan output
+	std::unique_ptr<kanavi_scan> m_scan;
+	std::vector<ros::Publisher> scan_publishers_;
+	sensor_msgs::LaserScan g_scanmsg;
+	ros::Time g_laststamp;
 
 	// rotate Angle
 	float rotate_angle;
@@ -193,11 +460,26 @@ public:
  * @param angle Rotation angle (radians).
  */
 	kanavi_node(const std::string &node_, int &argc_, char **argv_);
+
+/**
+ * @brief Constructor for the nodelet, publishers and subscribers live on the given handle.
+ * @param nh Node handle of the nodelet.
+ * @param queue Callback queue served by run() (odometry), set on the handle.
+ * @param node_ Model name (r2, r4, r270).
+ * @param argc_ Argument count.
+ * @param argv_ Argument values.
+ */
+	kanavi_node(const ros::NodeHandle &nh, ros::CallbackQueue *queue, const std::string &node_, int &argc_, char **argv_);
 	~kanavi_node();
 
 /**
  * @brief Main loop to receive, process, and publish LiDAR point cloud in ROS1.
  */
 	void run();
+
+/**
+ * @brief Makes run() return after the current packet (nodelet unload).
+ */
+	void stop() { running_ = false; }
 };
 #endif // __KANAVI_NODE_H__
\ No newline at end of file
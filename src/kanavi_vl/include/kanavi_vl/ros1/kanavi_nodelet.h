@@ -0,0 +1,61 @@
+#ifndef __KANAVI_NODELET_H__
+#define __KANAVI_NODELET_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_nodelet.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief ROS1 nodelet running kanavi_node on its own receive thread
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <nodelet/nodelet.h>
+#include <ros/callback_queue.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "kanavi_node.h"
+
+/**
+ * @class kanavi_nodelet
+ * @brief Loads kanavi_node into a nodelet manager.
+ *
+ * The model is the private parameter "model" (r2, r4, r270), the load
+ * arguments are the command-line options of the standalone nodes. The
+ * receive / parse loop runs on a thread of its own (the manager threads
+ * are never blocked) and clouds are published as shared_ptr, so nodelets
+ * of the same manager get them without serialization.
+ */
+class kanavi_nodelet : public nodelet::Nodelet
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Creates the node and starts the receive thread.
+ */
+	void onInit() override;
+	// !FUNTCIONS---
+
+	/* data */
+	ros::CallbackQueue queue_;	// node callbacks (odometry), served by the receive thread, outlives the node
+	std::unique_ptr<kanavi_node> node_;
+	std::thread thread_;
+
+public:
+	kanavi_nodelet();
+	~kanavi_nodelet();
+};
+
+#endif // __KANAVI_NODELET_H__
@@ -0,0 +1,100 @@
+#ifndef __KANAVI_FRAME_H__
+#define __KANAVI_FRAME_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_frame.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief native frame type, adapted to PointCloud2 (REP-2007) where rclcpp supports it
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <std_msgs/msg/header.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "kanavi_projection.h"
+#include "kanavi_cloud.h"
+#include "kanavi_palette.h"
+
+// type adaptation : rclcpp >= Humble
+#if __has_include(<rclcpp/type_adapter.hpp>)
+#include <rclcpp/type_adapter.hpp>
+#define KANAVI_TYPE_ADAPTER 1
+#else
+#define KANAVI_TYPE_ADAPTER 0
+#endif
+
+/**
+ * @brief one decoded frame, ranges only
+ *
+ * Same-process subscribers get the frame itself; the tables needed to
+ * build a PointCloud2 are shared, not copied, and the cloud is only written
+ * when a subscriber needs the ROS message.
+ */
+struct kanaviFrame
+{
+	std_msgs::msg::Header header;
+	int channels = 0;
+	int beams = 0;
+	std::vector<float> ranges;	// [m], channels x beams, channel major, 0 = no return or cropped
+
+	// state of the node when the frame was taken, nullptr = ranges only
+	std::shared_ptr<const kanavi_projection> projection;
+	std::shared_ptr<const kanavi_cloud> layout;
+	std::shared_ptr<const kanavi_palette> palette;
+
+	const float *row(int ch) const { return ranges.data() + static_cast<size_t>(ch) * beams; }
+};
+
+/**
+ * @brief Writes a frame into a PointCloud2 message (layout of the frame, organized or not).
+ * @param frame Source frame, an empty cloud without projection / layout / palette.
+ * @param msg Output message.
+ */
+void kanaviFrameToCloud(const kanaviFrame &frame, sensor_msgs::msg::PointCloud2 &msg);
+
+/**
+ * @brief Reads the ranges back from an organized PointCloud2 (range field, or distance of x y z).
+ * @param msg Source message, an unorganized cloud gives the header only.
+ * @param frame Output frame, without projection / layout / palette.
+ */
+void kanaviCloudToFrame(const sensor_msgs::msg::PointCloud2 &msg, kanaviFrame &frame);
+
+#if KANAVI_TYPE_ADAPTER
+template <>
+struct rclcpp::TypeAdapter<kanaviFrame, sensor_msgs::msg::PointCloud2>
+{
+	using is_specialized = std::true_type;
+	using custom_type = kanaviFrame;
+	using ros_message_type = sensor_msgs::msg::PointCloud2;
+
+	// only called for subscribers of the ROS message (other processes, PointCloud2 callbacks)
+	static void convert_to_ros_message(const custom_type &source, ros_message_type &destination)
+	{
+		kanaviFrameToCloud(source, destination);
+	}
+
+	static void convert_to_custom(const ros_message_type &source, custom_type &destination)
+	{
+		kanaviCloudToFrame(source, destination);
+	}
+};
+
+RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE(kanaviFrame, sensor_msgs::msg::PointCloud2);
+#endif
+
+#endif // __KANAVI_FRAME_H__
@@ -20,25 +20,48 @@
  */
 
 #include <rclcpp/rclcpp.hpp>
-#include <pcl/point_types.h>
-#include <pcl/point_cloud.h>
-#include <pcl/common/common.h>
-#include <pcl/common/transforms.h>
-#include <pcl/common/impl/angles.hpp>
-#include <pcl_conversions/pcl_conversions.h>
-#include <sensor_msgs/msg/point_cloud2.h>
-#include <sensor_msgs/point_cloud_conversion.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <sensor_msgs/msg/point_field.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/laser_scan.hpp>
+#include <std_msgs/msg/float32_multi_array.hpp>
+#include <std_msgs/msg/bool.hpp>
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+#include <kanavi_vl/msg/range_frame.hpp>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
+#include <tf2/LinearMath/Quaternion.h>
+#include <tf2/LinearMath/Matrix3x3.h>
 #include <std_msgs/msg/string.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "argv_parser.hpp"
 #include "udp.h"
 #include "kanavi_lidar.h"
+#include "kanavi_projection.h"
+#include "kanavi_palette.h"
+#include "kanavi_cloud.h"
+#include "kanavi_image.h"
+#include "kanavi_scan.h"
+#include "kanavi_calibration.h"
+#include "kanavi_crop.h"
+#include "kanavi_voxel.h"
+#include "kanavi_temporal.h"
+#include "kanavi_background.h"
+#include "kanavi_codec.h"
+#include "kanavi_zone.h"
+#include "kanavi_cluster.h"
+#include "kanavi_accumulate.h"
+#include "kanavi_frame.h"
 
-typedef pcl::PointXYZRGB PointT;
-typedef pcl::PointCloud<PointT> PointCloudT;
 using namespace std::chrono_literals;  // "10ms"와 같은 단위 사용을 위해 필요
 
 /**
@@ -46,7 +69,7 @@ using namespace std::chrono_literals;  // "10ms"와 같은 단위 사용을 위
  * @brief ROS2 node wrapper for Kanavi LiDAR sensor integration.
  *
  * This class manages receiving LiDAR data via UDP, parsing it into structured
- * data formats, converting it into PCL point clouds, and publishing to ROS topics.
+ * data formats, writing it into PointCloud2 messages, and publishing to ROS topics.
  */
 class kanavi_node : public rclcpp::Node
 {
@@ -54,6 +77,20 @@ private:
 
 	//SECTION - FUNCS.
 
+/**
+ * @brief Parses the arguments and sets up UDP, processing and publishers (shared by both constructors).
+ * @param node_ Model name (r2, r4, r270).
+ * @param argc_ Argument count.
+ * @param argv_ Argument values.
+ */
+	void initialize(const std::string &node_, int &argc_, char **argv_);
+
+/**
+ * @brief Builds command-line arguments from the node parameters (component).
+ * @return Arguments, one parameter per option named without the leading dash.
+ */
+	std::vector<std::string> parametersToArgv();
+
 /**
  * @brief Prints help information for using command-line arguments.
  */
@@ -64,6 +101,11 @@ private:
  */
 	void receiveData();
 
+/**
+ * @brief Receive thread, calls receiveData() until the node is destroyed or ROS shuts down.
+ */
+	void receiveLoop();
+
 /**
  * @brief Finalizes the node process and cleans up resources.
  */
@@ -76,53 +118,180 @@ private:
 
 
 /**
- * @brief Converts raw datagram into an internal point cloud representation.
+ * @brief Converts raw datagram into the reused PointCloud2 message.
  * @param datagram Parsed datagram from LiDAR sensor.
  */
-	void length2PointCloud(kanaviDatagram datagram);
+	void length2PointCloud(const kanaviDatagram &datagram);
 
 /**
- * @brief Converts a kanaviDatagram into a PCL-compatible point cloud.
+ * @brief Writes a whole kanaviDatagram into a PointCloud2 message.
  * @param datagram Parsed kanaviDatagram.
- * @param cloud_ Output point cloud.
+ * @param msg Output message (data buffer is reused).
  */
-	void generatePointCloud(const kanaviDatagram &datagram, PointCloudT &cloud_);
+	void generatePointCloud(const kanaviDatagram &datagram, sensor_msgs::msg::PointCloud2 &msg);
 
 /**
- * @brief Converts a length measurement and trigonometric values to a 3D point.
- * @param len Distance measurement.
- * @param v_sin Vertical sine.
- * @param v_cos Vertical cosine.
- * @param h_sin Horizontal sine.
- * @param h_cos Horizontal cosine.
- * @return Computed 3D point(XYZRGB).
+ * @brief Masks and projects one channel into the scratch rows (g_proj_*, g_valid).
+ * @param datagram Parsed kanaviDatagram.
+ * @param ch Channel index.
+ * @return Number of beams projected, 0 if the channel has no data or is cropped.
  */
-	PointT length2point(float len, float v_sin, float v_cos, float h_sin, float h_cos);
+	size_t projectChannel(const kanaviDatagram &datagram, int ch);
 
 /**
- * @brief Rotates the point cloud around the Z-axis by a given angle.
- * @param cloud Input/output point cloud.
- * @param angle Rotation angle in radians.
+ * @brief Writes a single channel of a kanaviDatagram into a PointCloud2 message.
+ * @param datagram Parsed kanaviDatagram.
+ * @param ch Channel index.
+ * @param layout Layout writer of the message.
+ * @param msg Output message (data buffer is reused).
+ * @param offset First point index to write at.
+ * @return Number of points written.
  */
-	void rotateAxisZ(PointCloudT::Ptr cloud, float angle);
-	
+	size_t generateChannelPointCloud(const kanaviDatagram &datagram, int ch, const kanavi_cloud &layout, sensor_msgs::msg::PointCloud2 &msg, size_t offset);
+
+/**
+ * @brief Creates a layout writer, falls back to the default layout on an invalid name.
+ * @param layout Layout name (KANAVI::CLOUD::LAYOUT_*).
+ * @return Layout writer.
+ */
+	std::unique_ptr<kanavi_cloud> createLayout(const std::string &layout);
+
+/**
+ * @brief Sets the field layout of a message once and reserves its data buffer.
+ * @param msg Message to initialize.
+ * @param layout Layout writer of the message.
+ * @param points Expected number of points per publish.
+ */
+	void initCloudMsg(sensor_msgs::msg::PointCloud2 &msg, const kanavi_cloud &layout, size_t points);
+
+/**
+ * @brief Sets width / height / row_step / data size after the points are written.
+ * @param msg Message to finish.
+ * @param width Points per row.
+ * @param height Number of rows (1 = unorganized).
+ */
+	void finishCloudMsg(sensor_msgs::msg::PointCloud2 &msg, size_t width, size_t height = 1);
+
+/**
+ * @brief Publishes a single decoded channel without waiting for the whole frame.
+ * @param ch Channel index.
+ * @param stamp Arrival time of the channel packet.
+ */
+	void publishChannel(int ch, const rclcpp::Time &stamp);
+
+/**
+ * @brief Publishes the reused frame message to a ROS2 topic.
+ * @param stamp Time stamp of the frame.
+ */
+	void publish_pointcloud(const rclcpp::Time &stamp);
+
+/**
+ * @brief Publishes a reused cloud message, handed over as unique_ptr with intra-process comms.
+ * @param publisher Target publisher.
+ * @param msg Reused message, its buffer is replaced by an empty one of the same capacity when handed over.
+ */
+	void publishCloud(const rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr &publisher, sensor_msgs::msg::PointCloud2 &msg);
+
+/**
+ * @brief Writes the decoded frame into the reused range image and publishes it.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishRangeImage(const rclcpp::Time &stamp);
+
+/**
+ * @brief Publishes the static beam angles of the range image (latched).
+ */
+	void publishBeamAngles();
+
+/**
+ * @brief Publishes the decoded frame as LaserScan, one message per ring.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishScan(const rclcpp::Time &stamp);
+
+/**
+ * @brief Downsamples the decoded frame on the voxel grid and publishes it.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishVoxel(const rclcpp::Time &stamp);
+
+/**
+ * @brief Learns the frame into the background and publishes the foreground beams & activity flag.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishForeground(const rclcpp::Time &stamp);
+
+/**
+ * @brief Encodes the frame as a keyframe or a delta and publishes it.
+ */
+	void publishDelta();
+
+/**
+ * @brief Publishes the state of the zones changed by the last frame.
+ * @param all Publish every zone (startup).
+ */
+	void publishZones(bool all);
+
+/**
+ * @brief Publishes the sensor status (detection bits & area configuration).
+ */
+	void publishStatus();
+
+/**
+ * @brief Segments the frame along scan order and publishes the clusters.
+ */
+	void publishClusters();
+
+/**
+ * @brief Writes the frame over the oldest row of the window, publishes the window every decimation frames.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishAccumulated(const rclcpp::Time &stamp);
+
+/**
+ * @brief Publishes the cropped ranges of the frame as a native kanaviFrame.
+ * @param stamp Time stamp of the frame.
+ */
+	void publishFrame(const rclcpp::Time &stamp);
+
+/**
+ * @brief Writes the cropped ranges of the frame, channel major.
+ * @param dst Destination, channels x beams ranges [m] (0 = no return or cropped).
+ */
+	void writeRanges(float *dst);
 
 /**
- * @brief Converts HSV color to RGB color.
- * @param fR Pointer to resulting red value.
- * @param fG Pointer to resulting green value.
- * @param fB Pointer to resulting blue value.
- * @param fH Hue component.
- * @param fS Saturation component.
- * @param fV Value component.
+ * @brief Publishes the cropped ranges in a fixed-size message, loaned from the middleware when it supports it.
+ * @param stamp Time stamp of the frame.
  */
-	void HSV2RGB(float *fR, float *fG, float *fB, float fH, float fS, float fV);
+	void publishRanges(const rclcpp::Time &stamp);
 
 /**
- * @brief Publishes the given point cloud to a ROS2 topic.
- * @param cloud_ Point cloud to publish.
+ * @brief Keeps the latest odometry pose for motion compensation.
+ * @param msg Odometry of the output frame.
  */
-	void publish_pointcloud(PointCloudT::Ptr cloud_);
+	void odometryCallback(const nav_msgs::msg::Odometry::SharedPtr msg);
+
+/**
+ * @brief Rebuilds the LaserScan angles from the current (calibrated) projection.
+ */
+	void updateScanAngles();
+
+/**
+ * @brief Rebuilds the projection when the sender or the calibration file changed.
+ *
+ * Polled once per KANAVI::CALIBRATION::RELOAD_PERIOD_MS, the current
+ * projection is kept when the new calibration is invalid.
+ */
+	void updateCalibration();
+
+/**
+ * @brief Looks up the static mounting pose (fixed frame <- sensor frame) once at startup.
+ *
+ * Keeps the -pose value when the transform is not available in time.
+ */
+	void lookupPose();
+
 	// need process...
 	
 	//!SETCION
@@ -142,12 +311,92 @@ private:
 	std::string topicName_;
 	std::string fixedName_;
 	rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr publisher_;
-	// timer for RECV
+	std::vector<rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr> channel_publishers_;
+	// timer for help
 	rclcpp::TimerBase::SharedPtr timer_;
+	// recv & parse thread, the blocking recvfrom stays off the executor
+	std::thread receive_thread_;
+	std::atomic<bool> running_;
+	// odometry callback (executor) and accumulation (receive thread)
+	std::mutex accumulate_mutex_;
 
 	// flags
 	bool checked_multicast_;
 	bool checked_help_;
+	bool checked_stream_;
+	bool checked_organized_;
+	bool checked_scan_;
+	bool intra_process_;	// component loaded with use_intra_process_comms
+
+	// coloring
+	std::string colorName_;
+	float colorRange_;
+
+	// PointCloud2 layouts
+	std::string layoutName_;
+	std::string streamLayoutName_;
+
+	// range image
+	std::string rangeImageUnit_;
+
+	// intrinsic calibration (hot-reloaded), keyed by sender IP
+	std::string calibPath_;
+	std::unique_ptr<kanavi_calibration> m_calibration;
+	std::string calibIP_;		// sender the projection was built for
+	int64_t g_calibcheck;		// last poll [ms]
+
+	// mounting pose folded into the projection, points are published in the fixed frame
+	KANAVI::CALIBRATION::extrinsic pose_;
+	std::string poseFrame_;
+	// range image & LaserScan are not posed, they carry the sensor frame
+	std::string sensorName_;
+
+	// crop, rebuilt with the projection
+	KANAVI::CROP::config crop_;
+	std::unique_ptr<kanavi_crop> m_crop;
+
+	// voxel grid settings
+	float voxelSize_;
+	std::string voxelPolicy_;
+
+	// temporal filter settings
+	std::string temporalMode_;
+	int temporalFrames_;
+	float temporalTolerance_;
+
+	// background model settings
+	bool checked_background_;
+	float backgroundTolerance_;
+	int backgroundFrames_;
+	int backgroundMinBeams_;
+
+	// delta frame settings
+	bool checked_delta_;
+	float deltaThreshold_;
+	int deltaInterval_;
+
+	// intrusion zone file
+	std::string zonePath_;
+
+	// sensor status output
+	bool checked_status_;
+
+	// clustering settings
+	bool checked_cluster_;
+	float clusterRangeJump_;
+	float clusterAngularGap_;
+	int clusterMinPoints_;
+
+	// sliding window settings
+	int accumulateFrames_;
+	int accumulateDecimation_;
+	std::string odomTopic_;
+
+	// native frame output
+	bool checked_frame_;
+
+	// fixed-size range frame output
+	bool checked_ranges_;
 
 	// rotate angle
 	float rotate_angle;
@@ -155,14 +404,92 @@ private:
 	// datagram
 	kanaviDatagram g_datagram;
 
-	// sin, cos value for calculate Angle
-	std::vector<float> v_sin;
-	std::vector<float> v_cos;
-	std::vector<float> h_sin;
-	std::vector<float> h_cos;
-
-	// pcl point cloud 
-	PointCloudT::Ptr g_pointcloud;
+	// beam direction table (base rotation & calibration included), shared with the frames in flight
+	std::shared_ptr<kanavi_projection> m_projection;
+
+	// range -> color table
+	std::shared_ptr<kanavi_palette> m_palette;
+
+	// PointCloud2 layout & writer (frame / channel stream)
+	std::shared_ptr<kanavi_cloud> m_cloud;
+	std::unique_ptr<kanavi_cloud> m_channelcloud;
+
+	// SoA scratch rows filled by the projection kernel (one channel)
+	std::vector<float> g_proj_x;
+	std::vector<float> g_proj_y;
+	std::vector<float> g_proj_z;
+
+	// validity row, 0 = dropped (NaN point in an organized cloud)
+	std::vector<uint8_t> g_valid;
+
+	// reused messages, data buffers keep their capacity between frames
+	sensor_msgs::msg::PointCloud2 g_cloudmsg;
+	sensor_msgs::msg::PointCloud2 g_channelmsg;
+
+	// range image output
+	std::unique_ptr<kanavi_image> m_image;
+	rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr image_publisher_;
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr angle_publisher_;
+	sensor_msgs::msg::Image g_imagemsg;
+
+	// per-beam temporal filter, runs on the range grid before any output
+	std::unique_ptr<kanavi_temporal> m_temporal;
+
+	// voxel grid output
+	std::unique_ptr<kanavi_voxel> m_voxel;
+	std::unique_ptr<kanavi_cloud> m_voxelcloud;
+	rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr voxel_publisher_;
+	sensor_msgs::msg::PointCloud2 g_voxelmsg;
+
+	// learned background, foreground only output
+	std::unique_ptr<kanavi_background> m_background;
+	std::unique_ptr<kanavi_cloud> m_foregroundcloud;
+	rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr foreground_publisher_;
+	rclcpp::Publisher<std_msgs::msg::Bool>::SharedPtr activity_publisher_;
+	sensor_msgs::msg::PointCloud2 g_foregroundmsg;
+	std_msgs::msg::Bool g_activitymsg;
+	bool g_foregroundsent;	// last foreground cloud was not empty
+
+	// keyframe + delta encoded frames
+	std::unique_ptr<kanavi_delta_encoder> m_delta;
+	rclcpp::Publisher<std_msgs::msg::UInt8MultiArray>::SharedPtr delta_publisher_;
+	std_msgs::msg::UInt8MultiArray g_deltamsg;
+
+	// intrusion zones, one latched Bool per zone
+	std::unique_ptr<kanavi_zone> m_zone;
+	std::vector<rclcpp::Publisher<std_msgs::msg::Bool>::SharedPtr> zone_publishers_;
+	std_msgs::msg::Bool g_zonemsg;
+
+	// sensor status, latched, published when it changes
+	rclcpp::Publisher<std_msgs::msg::UInt8MultiArray>::SharedPtr status_publisher_;
+	std_msgs::msg::UInt8MultiArray g_statusmsg;
+
+	// scan-order clusters, one row of KANAVI::CLUSTER::FIELDS per cluster
+	std::unique_ptr<kanavi_cluster> m_cluster;
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr cluster_publisher_;
+	std_msgs::msg::Float32MultiArray g_clustermsg;
+
+	// sliding window of the last frames, one organized row per frame
+	std::unique_ptr<kanavi_accumulate> m_accumulate;
+	std::unique_ptr<kanavi_cloud> m_acccloud;
+	rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr accumulate_publisher_;
+	rclcpp::Subscription<nav_msgs::msg::Odometry>::SharedPtr odom_subscriber_;
+	sensor_msgs::msg::PointCloud2 g_accmsg;
+
+	// fixed-size range frames, loaned when the middleware can, the reused message otherwise
+	rclcpp::Publisher<kanavi_vl::msg::RangeFrame>::SharedPtr ranges_publisher_;
+	kanavi_vl::msg::RangeFrame g_rangesmsg;
+
+#if KANAVI_TYPE_ADAPTER
+	// native frames, the PointCloud2 is only written for subscribers of the ROS message
+	rclcpp::Publisher<rclcpp::TypeAdapter<kanaviFrame, sensor_msgs::msg::PointCloud2>>::SharedPtr frame_publisher_;
+#endif
+
+	// LaserScan output
+	std::unique_ptr<kanavi_scan> m_scan;
+	std::vector<rclcpp::Publisher<sensor_msgs::msg::LaserScan>::SharedPtr> scan_publishers_;
+	sensor_msgs::msg::LaserScan g_scanmsg;
+	int64_t g_laststamp;	// [ns], kept as integer to avoid mixing clock types
 
 	// UDP network
 	std::unique_ptr<kanavi_udp> m_udp;
@@ -180,6 +507,12 @@ public:
  * @param argv_ Argument values.
  */
 	kanavi_node(const std::string &node_, int &argc_, char **argv_);
+
+/**
+ * @brief Constructor for the composable node (rclcpp_components).
+ * @param options Node options, the options are read from the node parameters.
+ */
+	explicit kanavi_node(const rclcpp::NodeOptions &options);
 	~kanavi_node();
 
 /**
@@ -0,0 +1,148 @@
+#ifndef __KANAVI_VOXEL_H__
+#define __KANAVI_VOXEL_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_voxel.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief allocation-free voxel grid downsampling
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KANAVI
+{
+	namespace VOXEL
+	{
+		const std::string CENTROID	= "centroid";	// mean of the points in the voxel
+		const std::string FIRST		= "first";		// first point in scan order
+
+		enum POLICY
+		{
+			POLICY_CENTROID = 0,
+			POLICY_FIRST = 1
+		};
+
+		const int KEY_BITS = 21;	// per axis, +-2^20 voxels
+	}
+}
+
+/**
+ * @class kanavi_voxel
+ * @brief Voxel grid on a preallocated open-addressing hash table.
+ *
+ * Every buffer is sized once for the largest frame (channels x beams), a
+ * frame only bumps a generation counter instead of clearing the table, so
+ * downsampling never allocates. Voxels come out in order of first hit.
+ */
+class kanavi_voxel
+{
+private:
+	struct slot
+	{
+		uint64_t key;
+		uint32_t gen;	// slot is empty unless gen == gen_
+		uint32_t index;	// voxel index in the output rows
+	};
+
+	/* data */
+	KANAVI::VOXEL::POLICY policy_;
+	std::string policy_name_;
+	float leaf_;		// [m]
+	float inv_leaf_;
+	size_t capacity_;	// max points per frame
+
+	std::vector<slot> table_;	// power of 2, >= 2 * capacity_
+	size_t mask_;
+	uint32_t gen_;
+
+	// per voxel (sum until finish()), SoA
+	std::vector<float> x_;
+	std::vector<float> y_;
+	std::vector<float> z_;
+	std::vector<float> len_;
+	std::vector<uint32_t> count_;
+	size_t used_;
+
+public:
+/**
+ * @brief Constructor for kanavi_voxel.
+ * @param leaf Voxel edge length [m].
+ * @param policy KANAVI::VOXEL::CENTROID or KANAVI::VOXEL::FIRST.
+ * @param capacity Max points inserted per frame.
+ * @throws std::runtime_error on an invalid leaf size or policy.
+ */
+	kanavi_voxel(float leaf, const std::string &policy, size_t capacity);
+	~kanavi_voxel();
+
+/**
+ * @brief Starts a new frame, O(1).
+ */
+	void clear();
+
+/**
+ * @brief Adds one row of points.
+ * @param x X row.
+ * @param y Y row.
+ * @param z Z row.
+ * @param len Range row [m].
+ * @param valid Validity row (0 = skip), nullptr = every point valid.
+ * @param count Number of points.
+ */
+	void insert(const float *x, const float *y, const float *z, const float *len, const uint8_t *valid, int count);
+
+/**
+ * @brief Turns the sums into centroids, call once after the last insert().
+ */
+	void finish();
+
+/**
+ * @brief Returns the number of voxels of the frame.
+ */
+	size_t size() const { return used_; }
+
+/**
+ * @brief Returns the voxel X row (size() elements, after finish()).
+ */
+	const float *getX() const { return x_.data(); }
+
+/**
+ * @brief Returns the voxel Y row (size() elements, after finish()).
+ */
+	const float *getY() const { return y_.data(); }
+
+/**
+ * @brief Returns the voxel Z row (size() elements, after finish()).
+ */
+	const float *getZ() const { return z_.data(); }
+
+/**
+ * @brief Returns the voxel range row [m] (size() elements, after finish()).
+ */
+	const float *getRange() const { return len_.data(); }
+
+/**
+ * @brief Returns the voxel edge length [m].
+ */
+	float getLeafSize() const { return leaf_; }
+
+/**
+ * @brief Returns the policy name.
+ */
+	const std::string &getPolicy() const { return policy_name_; }
+};
+
+#endif // __KANAVI_VOXEL_H__
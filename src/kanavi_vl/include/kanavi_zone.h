@@ -0,0 +1,158 @@
+#ifndef __KANAVI_ZONE_H__
+#define __KANAVI_ZONE_H__
+
+// Copyright (c) 2025, Kanavi Mobility
+// All rights reserved.
+//
+// This file is part of the ROS1/ROS2 Hybrid Build Project.
+// Licensed under the BSD 3-Clause License.
+// You may obtain a copy of the License at the root of this repository (LICENSE file).
+
+/**
+ * @file kanavi_zone.h
+ * @author twchong (twchong@kanavi-mobility.com)
+ * @brief polygon intrusion zones compiled into per-beam range intervals
+ * @version 0.1
+ * @date 2025-06-01
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Zone file : one section per zone, the section name is the zone name
+ * (letters, digits and '_'). Polygons are in the sensor frame XY plane,
+ * base rotation included, any height.
+ *
+ * ex)	# platform screen door 1
+ * 		[door_1]
+ * 		polygon = 0.5 -1.0  3.0 -1.0  3.0 1.0  0.5 1.0	# x y pairs [m], >= 3 vertices
+ * 		range = 0.3 8.0									# measured range [min max] [m], optional
+ * 		min_points = 3									# returns of an occupied zone, optional
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class kanavi_projection;
+
+namespace KANAVI
+{
+	namespace ZONE
+	{
+		const std::string KEY_POLYGON = "polygon";
+		const std::string KEY_RANGE = "range";
+		const std::string KEY_MIN_POINTS = "min_points";
+
+		const int DEFAULT_MIN_POINTS = 3;
+
+		/**
+		 * @brief one zone of the zone file
+		 */
+		struct zone
+		{
+			std::string name;
+			std::vector<float> polygon;	// x0 y0 x1 y1 ... [m]
+			float range_min;			// [m], measured range
+			float range_max;			// [m]
+			int min_points;
+
+			zone() : range_min(0), range_max(1e9f), min_points(DEFAULT_MIN_POINTS) {}
+		};
+	}
+}
+
+/**
+ * @class kanavi_zone
+ * @brief Evaluates intrusion zones with one pass of range compares per frame.
+ *
+ * A beam is a ray, so the part of it inside a polygon (even-odd rule,
+ * concave polygons split into several pieces) and the range limits reduce
+ * to a few [lo, hi] range intervals. compile() turns every zone into a
+ * flat list of (beam, interval) entries grouped by channel, and
+ * evaluate() only counts the returns falling inside an entry. No geometry
+ * is left on the frame path.
+ */
+class kanavi_zone
+{
+private:
+	// FUNCTIONS----
+/**
+ * @brief Loads the zone file.
+ * @return Error message, empty on success.
+ */
+	std::string load(const std::string &path);
+	// !FUNTCIONS---
+
+	/* data */
+	std::vector<KANAVI::ZONE::zone> zones_;
+
+	// entries grouped by channel, channel ch uses [first_[ch], first_[ch + 1])
+	std::vector<uint32_t> first_;
+	std::vector<uint16_t> beam_;
+	std::vector<uint16_t> zone_;
+	std::vector<float> lo_;
+	std::vector<float> hi_;
+
+	// per zone
+	std::vector<uint32_t> count_;
+	std::vector<uint8_t> occupied_;
+	std::vector<uint8_t> changed_;	// by the last evaluate()
+
+public:
+/**
+ * @brief Constructor for kanavi_zone.
+ * @param path Zone file.
+ * @throws std::runtime_error if the file can not be read or is invalid.
+ */
+	explicit kanavi_zone(const std::string &path);
+	~kanavi_zone();
+
+/**
+ * @brief Builds the per-beam range intervals, rebuild when the projection changes.
+ * @param projection Beam angles of the sensor.
+ */
+	void compile(const kanavi_projection &projection);
+
+/**
+ * @brief Counts the returns of one frame in every zone.
+ * @param len_buf Range rows of the frame [m], one per channel.
+ * @return true if the state of any zone changed.
+ */
+	bool evaluate(const std::vector< std::vector<float> > &len_buf);
+
+/**
+ * @brief Returns the number of zones.
+ */
+	size_t size() const { return zones_.size(); }
+
+/**
+ * @brief Returns the name of a zone.
+ * @param i Zone index (file order).
+ */
+	const std::string &getName(size_t i) const { return zones_[i].name; }
+
+/**
+ * @brief Returns true if the zone held at least min_points returns in the last frame.
+ * @param i Zone index (file order).
+ */
+	bool isOccupied(size_t i) const { return occupied_[i] != 0; }
+
+/**
+ * @brief Returns true if the zone changed state in the last frame.
+ * @param i Zone index (file order).
+ */
+	bool isChanged(size_t i) const { return changed_[i] != 0; }
+
+/**
+ * @brief Returns the returns counted in a zone in the last frame.
+ * @param i Zone index (file order).
+ */
+	uint32_t getCount(size_t i) const { return count_[i]; }
+
+/**
+ * @brief Returns the number of compiled (beam, interval) entries.
+ */
+	size_t getEntries() const { return beam_.size(); }
+};
+
+#endif // __KANAVI_ZONE_H__
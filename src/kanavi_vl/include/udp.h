@@ -28,6 +28,7 @@
 #include <arpa/inet.h>
 #include <unistd.h>     // close
 #include <vector>
+#include <stdexcept>
 
 #include <cassert>
 #include <algorithm>
@@ -69,6 +70,7 @@ private:
 	//SECTION -- VARS.
 	struct sockaddr_in g_udpAddr;
 	struct sockaddr_in g_senderAddr;
+	std::string g_senderIP;		// sender of the last received packet
 	int g_udpSocket;
 
 	struct ip_mreq multi_Addr;
@@ -95,6 +97,11 @@ public:
  */
 	std::vector<u_char> getData();
 
+/**
+ * @brief Returns the sender IP of the last received packet (empty before the first one).
+ */
+	const std::string &getSenderIP() const { return g_senderIP; }
+
 /**
  * @brief Sends a UDP packet to the configured address (Not Used).
  * 
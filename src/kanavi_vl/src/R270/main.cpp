@@ -8,9 +8,16 @@ int main(int argc, char **argv)
 {
 	ros::init(argc, argv, "r270");
 
-	kanavi_node node("r270", argc, argv);
-
-	node.run();
+	try
+	{
+		kanavi_node node("r270", argc, argv);
+		node.run();
+	}
+	catch (const std::exception &e)
+	{
+		printf("[NODE] %s\n", e.what());
+		return 1;
+	}
 
 	return 0;
 }
@@ -7,8 +7,16 @@
 int main(int argc, char **argv)
 {
 	ros::init(argc, argv, "r4");
-	kanavi_node node("r4", argc, argv);
-	node.run();
+	try
+	{
+		kanavi_node node("r4", argc, argv);
+		node.run();
+	}
+	catch (const std::exception &e)
+	{
+		printf("[NODE] %s\n", e.what());
+		return 1;
+	}
 
 	return 0;
 }
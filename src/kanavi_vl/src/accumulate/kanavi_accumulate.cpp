@@ -0,0 +1,105 @@
+#include "kanavi_accumulate.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Construct a new kanavi accumulate::kanavi accumulate object
+ *
+ * @param frames frames in the window
+ * @param decimation window published every N frames
+ * @param capacity points per frame
+ */
+kanavi_accumulate::kanavi_accumulate(int frames, int decimation, size_t capacity)
+	: frames_(frames), decimation_(decimation), capacity_(capacity),
+	  next_(0), filled_(0), since_publish_(0), has_pose_(false)
+{
+	if (frames < 1 || frames > KANAVI::ACCUMULATE::MAX_FRAMES)
+	{
+		throw std::runtime_error("Invalid accumulation frames : " + std::to_string(frames));
+	}
+	if (decimation < 1)
+	{
+		throw std::runtime_error("Invalid accumulation decimation : " + std::to_string(decimation));
+	}
+	if (capacity == 0)
+	{
+		throw std::runtime_error("Invalid accumulation capacity");
+	}
+
+	for (int i = 0; i < 9; i++)
+	{
+		r_[i] = (i % 4 == 0) ? 1.0f : 0.0f;
+	}
+	t_[0] = t_[1] = t_[2] = 0;
+}
+
+kanavi_accumulate::~kanavi_accumulate()
+{
+}
+
+void kanavi_accumulate::setPose(double x, double y, double z, double qx, double qy, double qz, double qw)
+{
+	double n = std::sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+	if (!(n > 0))
+	{
+		return;
+	}
+	qx /= n;
+	qy /= n;
+	qz /= n;
+	qw /= n;
+
+	// row-major rotation of the unit quaternion
+	r_[0] = static_cast<float>(1 - 2 * (qy * qy + qz * qz));
+	r_[1] = static_cast<float>(2 * (qx * qy - qz * qw));
+	r_[2] = static_cast<float>(2 * (qx * qz + qy * qw));
+	r_[3] = static_cast<float>(2 * (qx * qy + qz * qw));
+	r_[4] = static_cast<float>(1 - 2 * (qx * qx + qz * qz));
+	r_[5] = static_cast<float>(2 * (qy * qz - qx * qw));
+	r_[6] = static_cast<float>(2 * (qx * qz - qy * qw));
+	r_[7] = static_cast<float>(2 * (qy * qz + qx * qw));
+	r_[8] = static_cast<float>(1 - 2 * (qx * qx + qy * qy));
+	t_[0] = static_cast<float>(x);
+	t_[1] = static_cast<float>(y);
+	t_[2] = static_cast<float>(z);
+	has_pose_ = true;
+}
+
+size_t kanavi_accumulate::begin()
+{
+	return static_cast<size_t>(next_) * capacity_;
+}
+
+void kanavi_accumulate::transform(float *x, float *y, float *z, int count) const
+{
+	if (!has_pose_)
+	{
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		float px = x[i], py = y[i], pz = z[i];
+		x[i] = r_[0] * px + r_[1] * py + r_[2] * pz + t_[0];
+		y[i] = r_[3] * px + r_[4] * py + r_[5] * pz + t_[1];
+		z[i] = r_[6] * px + r_[7] * py + r_[8] * pz + t_[2];
+	}
+}
+
+bool kanavi_accumulate::end()
+{
+	next_ = (next_ + 1) % frames_;
+	if (filled_ < frames_)
+	{
+		filled_++;
+	}
+
+	if (++since_publish_ < decimation_)
+	{
+		return false;
+	}
+	since_publish_ = 0;
+	return true;
+}
@@ -0,0 +1,146 @@
+#include "kanavi_background.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const float CM_PER_M = 100.0f;
+	const float RANGE_MAX_CM = 32767.0f;
+	const int FRAMES_MAX = 65535;	// uint16 candidate counter
+}
+
+/**
+ * @brief Construct a new kanavi background::kanavi background object
+ *
+ * @param tolerance range agreement [m]
+ * @param frames adaptation frames
+ * @param min_beams foreground beams of an active frame
+ * @param channels grid channels
+ * @param beams grid beams per channel
+ */
+kanavi_background::kanavi_background(float tolerance, int frames, int min_beams, int channels, int beams)
+	: tolerance_(0), frames_(frames), min_beams_(min_beams), channels_(channels), beams_(beams),
+	  learned_(0), foreground_count_(0)
+{
+	if (!(tolerance > 0))
+	{
+		throw std::runtime_error("Invalid background tolerance : " + std::to_string(tolerance));
+	}
+	if (frames < 1 || frames > FRAMES_MAX)
+	{
+		throw std::runtime_error("Invalid background frames : " + std::to_string(frames));
+	}
+	if (min_beams < 1)
+	{
+		throw std::runtime_error("Invalid background min beams : " + std::to_string(min_beams));
+	}
+	if (channels <= 0 || beams <= 0)
+	{
+		throw std::runtime_error("Invalid background grid : " + std::to_string(channels) + " x " + std::to_string(beams));
+	}
+	tolerance_ = static_cast<int16_t>(std::min(tolerance * CM_PER_M + 0.5f, RANGE_MAX_CM));
+
+	size_t total = static_cast<size_t>(channels_) * beams_;
+	background_.assign(total, 0);
+	candidate_.assign(total, 0);
+	candidate_count_.assign(total, 0);
+	foreground_.assign(total, 0);
+}
+
+kanavi_background::~kanavi_background()
+{
+}
+
+void kanavi_background::update(const std::vector< std::vector<float> > &len_buf)
+{
+	bool first = (learned_ == 0);
+	bool learned = isLearned();
+	foreground_count_ = 0;
+
+	int channels = std::min(static_cast<int>(len_buf.size()), channels_);
+	for (int ch = 0; ch < channels; ch++)
+	{
+		const std::vector<float> &len = len_buf[ch];
+		int count = std::min(static_cast<int>(len.size()), beams_);
+		size_t row = static_cast<size_t>(ch) * beams_;
+
+		int16_t *bg = background_.data() + row;
+		int16_t *cand = candidate_.data() + row;
+		uint16_t *cand_count = candidate_count_.data() + row;
+		uint8_t *fg = foreground_.data() + row;
+
+		for (int i = 0; i < count; i++)
+		{
+			int r = static_cast<int>(std::min(std::max(len[i], 0.0f) * CM_PER_M + 0.5f, RANGE_MAX_CM));
+			if (first)
+			{
+				bg[i] = static_cast<int16_t>(r);
+			}
+
+			// classify against the background of the previous frames
+			uint8_t is_fg = static_cast<uint8_t>(learned && r > 0 && (bg[i] == 0 || r < bg[i] - tolerance_));
+			fg[i] = is_fg;
+			foreground_count_ += is_fg;
+
+			int d = r - bg[i];
+			if (std::abs(d) <= tolerance_)
+			{
+				// static : refine, a pending candidate is dropped
+				bg[i] = static_cast<int16_t>(bg[i] + d / (1 << KANAVI::BACKGROUND::EMA_SHIFT));
+				cand_count[i] = 0;
+				continue;
+			}
+
+			if (cand_count[i] > 0 && std::abs(r - cand[i]) <= tolerance_)
+			{
+				cand_count[i]++;
+			}
+			else
+			{
+				cand[i] = static_cast<int16_t>(r);
+				cand_count[i] = 1;
+			}
+
+			// the candidate stayed long enough, it is the new background
+			if (cand_count[i] >= frames_)
+			{
+				bg[i] = cand[i];
+				cand_count[i] = 0;
+			}
+		}
+
+		std::fill(fg + count, fg + beams_, 0);
+	}
+	std::fill(foreground_.begin() + static_cast<size_t>(channels) * beams_, foreground_.end(), 0);
+
+	if (learned_ < frames_)
+	{
+		learned_++;
+	}
+}
+
+int kanavi_background::mask(int ch, int count, uint8_t *valid) const
+{
+	if (ch < 0 || ch >= channels_)
+	{
+		std::fill(valid, valid + count, 0);
+		return 0;
+	}
+	if (count > beams_)
+	{
+		count = beams_;
+	}
+
+	const uint8_t *fg = foreground_.data() + static_cast<size_t>(ch) * beams_;
+
+	int kept = 0;
+	for (int i = 0; i < count; i++)
+	{
+		valid[i] &= fg[i];
+		kept += valid[i];
+	}
+	return kept;
+}
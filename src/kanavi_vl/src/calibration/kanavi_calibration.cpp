@@ -0,0 +1,191 @@
+#include "kanavi_calibration.h"
+#include "kanavi_log.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace
+{
+	std::string trim(const std::string &s)
+	{
+		size_t first = s.find_first_not_of(" \t\r\n");
+		if (first == std::string::npos)
+		{
+			return "";
+		}
+		size_t last = s.find_last_not_of(" \t\r\n");
+		return s.substr(first, last - first + 1);
+	}
+
+	bool parseList(const std::string &text, std::vector<float> &out)
+	{
+		std::string values = text;
+		for (char &c : values)
+		{
+			if (c == ',')
+			{
+				c = ' ';
+			}
+		}
+
+		std::istringstream ss(values);
+		std::string token;
+		out.clear();
+		while (ss >> token)
+		{
+			try
+			{
+				size_t used = 0;
+				out.push_back(std::stof(token, &used));
+				if (used != token.size())
+				{
+					return false;
+				}
+			}
+			catch (const std::exception &)
+			{
+				return false;
+			}
+		}
+		return !out.empty();
+	}
+}
+
+/**
+ * @brief Construct a new kanavi calibration::kanavi calibration object
+ *
+ * @param path calibration file path
+ */
+kanavi_calibration::kanavi_calibration(const std::string &path)
+	: path_(path), mtime_(0)
+{
+	if (!load())
+	{
+		throw std::runtime_error("Invalid calibration file : " + path);
+	}
+}
+
+kanavi_calibration::~kanavi_calibration()
+{
+}
+
+time_t kanavi_calibration::modifiedTime() const
+{
+	struct stat st;
+	if (stat(path_.c_str(), &st) != 0)
+	{
+		return 0;
+	}
+	return st.st_mtime;
+}
+
+bool kanavi_calibration::isModified() const
+{
+	time_t mtime = modifiedTime();
+	return mtime != 0 && mtime != mtime_;
+}
+
+bool kanavi_calibration::load()
+{
+	// a broken file is not retried until it changes again
+	mtime_ = modifiedTime();
+
+	std::ifstream file(path_);
+	if (!file.is_open())
+	{
+		KANAVI_LOG_WARN("[CALIB] can not open %s\n", path_);
+		return false;
+	}
+
+	std::map<std::string, KANAVI::CALIBRATION::intrinsic> sections;
+	KANAVI::CALIBRATION::intrinsic *current = nullptr;
+
+	std::string line;
+	int line_no = 0;
+	while (std::getline(file, line))
+	{
+		line_no++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+		line = trim(line);
+		if (line.empty())
+		{
+			continue;
+		}
+
+		// [section]
+		if (line.front() == '[')
+		{
+			if (line.back() != ']' || line.size() < 3)
+			{
+				KANAVI_LOG_WARN("[CALIB] line %d : invalid section\n", line_no);
+				return false;
+			}
+			current = &sections[trim(line.substr(1, line.size() - 2))];
+			continue;
+		}
+
+		// key = values
+		size_t eq = line.find('=');
+		if (eq == std::string::npos || current == nullptr)
+		{
+			KANAVI_LOG_WARN("[CALIB] line %d : expected key = values in a section\n", line_no);
+			return false;
+		}
+
+		std::string key = trim(line.substr(0, eq));
+		std::vector<float> *target = nullptr;
+		if (key == KANAVI::CALIBRATION::KEY_VERTICAL)
+		{
+			target = &current->vertical;
+		}
+		else if (key == KANAVI::CALIBRATION::KEY_AZIMUTH_OFFSET)
+		{
+			target = &current->azimuth_offset;
+		}
+		else if (key == KANAVI::CALIBRATION::KEY_RANGE_OFFSET)
+		{
+			target = &current->range_offset;
+		}
+		else if (key == KANAVI::CALIBRATION::KEY_RANGE_SCALE)
+		{
+			target = &current->range_scale;
+		}
+		else
+		{
+			KANAVI_LOG_WARN("[CALIB] line %d : unknown key %s\n", line_no, key);
+			return false;
+		}
+
+		if (!parseList(line.substr(eq + 1), *target))
+		{
+			KANAVI_LOG_WARN("[CALIB] line %d : invalid value of %s\n", line_no, key);
+			return false;
+		}
+	}
+
+	sections_.swap(sections);
+	return true;
+}
+
+bool kanavi_calibration::find(const std::string &ip, KANAVI::CALIBRATION::intrinsic &out) const
+{
+	auto it = sections_.find(ip);
+	if (it == sections_.end())
+	{
+		it = sections_.find(KANAVI::CALIBRATION::DEFAULT_SECTION);
+	}
+	if (it == sections_.end())
+	{
+		return false;
+	}
+
+	out = it->second;
+	return true;
+}
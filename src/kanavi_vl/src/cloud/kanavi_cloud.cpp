@@ -0,0 +1,279 @@
+#include "kanavi_cloud.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+	//SECTION - point records, must match the fields of each layout
+	struct pointXYZ
+	{
+		float x;
+		float y;
+		float z;
+	};
+
+	struct pointXYZRGB
+	{
+		float x;
+		float y;
+		float z;
+		uint32_t rgb;
+	};
+
+	struct pointXYZRBR
+	{
+		float x;
+		float y;
+		float z;
+		uint16_t ring;
+		uint16_t beam;
+		float range;
+	};
+
+	struct pointXYZ16
+	{
+		int16_t x;
+		int16_t y;
+		int16_t z;
+	};
+
+	static_assert(sizeof(pointXYZ) == 12, "pointXYZ must be packed");
+	static_assert(sizeof(pointXYZRGB) == 16, "pointXYZRGB must be packed");
+	static_assert(sizeof(pointXYZRBR) == 20, "pointXYZRBR must be packed");
+	static_assert(sizeof(pointXYZ16) == 6, "pointXYZ16 must be packed");
+	//!SECTION
+
+	const float MM_LIMIT = 32.767f;	// [m], int16 millimetre range
+	const float INVALID = std::numeric_limits<float>::quiet_NaN();
+
+	template <typename T>
+	inline void put(uint8_t *dst, int i, const T &p_)
+	{
+		memcpy(dst + static_cast<size_t>(i) * sizeof(T), &p_, sizeof(T));
+	}
+
+	/**
+	 * @brief common loop of every layout
+	 *
+	 * fill(p_, i) writes a valid beam and returns false when the layout can
+	 * not represent it; invalid(p_, i) writes a beam kept in an organized
+	 * cloud. Unorganized clouds just skip invalid or unrepresentable beams.
+	 */
+	template <typename T, typename FILL, typename INVALID>
+	inline int emit(uint8_t *dst, const uint8_t *valid, bool organized, int count, FILL fill, INVALID invalid)
+	{
+		T p_;
+		memset(&p_, 0, sizeof(p_));
+
+		int n = 0;
+		for (int i = 0; i < count; i++)
+		{
+			if ((valid && !valid[i]) || !fill(p_, i))
+			{
+				if (!organized)
+				{
+					continue;
+				}
+				invalid(p_, i);
+			}
+			put(dst, n++, p_);
+		}
+		return n;
+	}
+
+	//SECTION - invalid records
+	inline void invalidate(pointXYZ &p_)
+	{
+		p_.x = p_.y = p_.z = INVALID;
+	}
+
+	inline void invalidate(pointXYZRGB &p_)
+	{
+		p_.x = p_.y = p_.z = INVALID;
+		p_.rgb = 0;
+	}
+
+	inline void invalidate(pointXYZRBR &p_)
+	{
+		p_.x = p_.y = p_.z = INVALID;
+		p_.range = INVALID;
+	}
+
+	inline void invalidate(pointXYZ16 &p_)
+	{
+		p_.x = p_.y = p_.z = 0;
+	}
+	//!SECTION
+}
+
+/**
+ * @brief Construct a new kanavi cloud::kanavi cloud object
+ *
+ * @param layout layout name ref include/kanavi_cloud.h
+ * @param organized keep invalid beams as NaN
+ */
+kanavi_cloud::kanavi_cloud(const std::string &layout, bool organized)
+	: layout_(KANAVI::CLOUD::XYZRGB), name_(layout), organized_(organized), point_step_(0)
+{
+	if (layout == KANAVI::CLOUD::LAYOUT_XYZ)
+	{
+		layout_ = KANAVI::CLOUD::XYZ;
+		addField("x", KANAVI::CLOUD::FLOAT32, 4);
+		addField("y", KANAVI::CLOUD::FLOAT32, 4);
+		addField("z", KANAVI::CLOUD::FLOAT32, 4);
+	}
+	else if (layout == KANAVI::CLOUD::LAYOUT_XYZRGB)
+	{
+		layout_ = KANAVI::CLOUD::XYZRGB;
+		addField("x", KANAVI::CLOUD::FLOAT32, 4);
+		addField("y", KANAVI::CLOUD::FLOAT32, 4);
+		addField("z", KANAVI::CLOUD::FLOAT32, 4);
+		addField("rgb", KANAVI::CLOUD::FLOAT32, 4);	// packed 0x00RRGGBB, as pcl/rviz expect
+	}
+	else if (layout == KANAVI::CLOUD::LAYOUT_XYZRBR)
+	{
+		layout_ = KANAVI::CLOUD::XYZRBR;
+		addField("x", KANAVI::CLOUD::FLOAT32, 4);
+		addField("y", KANAVI::CLOUD::FLOAT32, 4);
+		addField("z", KANAVI::CLOUD::FLOAT32, 4);
+		addField("ring", KANAVI::CLOUD::UINT16, 2);
+		addField("beam", KANAVI::CLOUD::UINT16, 2);
+		addField("range", KANAVI::CLOUD::FLOAT32, 4);
+	}
+	else if (layout == KANAVI::CLOUD::LAYOUT_XYZ16)
+	{
+		layout_ = KANAVI::CLOUD::XYZ16;
+		addField("x", KANAVI::CLOUD::INT16, 2);
+		addField("y", KANAVI::CLOUD::INT16, 2);
+		addField("z", KANAVI::CLOUD::INT16, 2);
+	}
+	else
+	{
+		throw std::runtime_error("Invalid layout : " + layout);
+	}
+}
+
+kanavi_cloud::~kanavi_cloud()
+{
+}
+
+void kanavi_cloud::addField(const std::string &name, uint8_t datatype, uint32_t size)
+{
+	KANAVI::CLOUD::field f;
+	f.name = name;
+	f.offset = point_step_;
+	f.datatype = datatype;
+	f.count = 1;
+	fields_.push_back(f);
+
+	point_step_ += size;
+}
+
+int kanavi_cloud::write(uint8_t *dst, const float *x, const float *y, const float *z, const float *len,
+						const uint8_t *valid, int ch, int count, const kanavi_palette &palette) const
+{
+	switch (layout_)
+	{
+	case KANAVI::CLOUD::XYZ:
+		return emit<pointXYZ>(dst, valid, organized_, count,
+			[&](pointXYZ &p_, int i)
+			{
+				p_.x = x[i];
+				p_.y = y[i];
+				p_.z = z[i];
+				return true;
+			},
+			[](pointXYZ &p_, int) { invalidate(p_); });
+	case KANAVI::CLOUD::XYZRGB:
+	{
+		bool coloring = palette.isEnabled();
+		return emit<pointXYZRGB>(dst, valid, organized_, count,
+			[&](pointXYZRGB &p_, int i)
+			{
+				p_.x = x[i];
+				p_.y = y[i];
+				p_.z = z[i];
+				p_.rgb = coloring ? palette.color(len[i]) : 0;
+				return true;
+			},
+			[](pointXYZRGB &p_, int) { invalidate(p_); });
+	}
+	case KANAVI::CLOUD::XYZRBR:
+		return emit<pointXYZRBR>(dst, valid, organized_, count,
+			[&](pointXYZRBR &p_, int i)
+			{
+				p_.x = x[i];
+				p_.y = y[i];
+				p_.z = z[i];
+				p_.ring = static_cast<uint16_t>(ch);
+				p_.beam = static_cast<uint16_t>(i);
+				p_.range = len[i];
+				return true;
+			},
+			[&](pointXYZRBR &p_, int i)
+			{
+				invalidate(p_);
+				p_.ring = static_cast<uint16_t>(ch);
+				p_.beam = static_cast<uint16_t>(i);
+			});
+	case KANAVI::CLOUD::XYZ16:
+		return emit<pointXYZ16>(dst, valid, organized_, count,
+			[&](pointXYZ16 &p_, int i)
+			{
+				// out of int16 millimetre range, handled like a beam without return
+				if (fabsf(x[i]) > MM_LIMIT || fabsf(y[i]) > MM_LIMIT || fabsf(z[i]) > MM_LIMIT)
+				{
+					return false;
+				}
+				p_.x = static_cast<int16_t>(lrintf(x[i] * 1000));
+				p_.y = static_cast<int16_t>(lrintf(y[i] * 1000));
+				p_.z = static_cast<int16_t>(lrintf(z[i] * 1000));
+				return true;
+			},
+			[](pointXYZ16 &p_, int) { invalidate(p_); });
+	}
+	return 0;
+}
+
+void kanavi_cloud::writeInvalid(uint8_t *dst, int ch, int first, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		switch (layout_)
+		{
+		case KANAVI::CLOUD::XYZ:
+		{
+			pointXYZ p_;
+			invalidate(p_);
+			put(dst, i, p_);
+			break;
+		}
+		case KANAVI::CLOUD::XYZRGB:
+		{
+			pointXYZRGB p_;
+			invalidate(p_);
+			put(dst, i, p_);
+			break;
+		}
+		case KANAVI::CLOUD::XYZRBR:
+		{
+			pointXYZRBR p_;
+			invalidate(p_);
+			p_.ring = static_cast<uint16_t>(ch);
+			p_.beam = static_cast<uint16_t>(first + i);
+			put(dst, i, p_);
+			break;
+		}
+		case KANAVI::CLOUD::XYZ16:
+		{
+			pointXYZ16 p_;
+			invalidate(p_);
+			put(dst, i, p_);
+			break;
+		}
+		}
+	}
+}
@@ -0,0 +1,191 @@
+#include "kanavi_cluster.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const uint32_t NONE = UINT32_MAX;
+}
+
+/**
+ * @brief Construct a new kanavi cluster::kanavi cluster object
+ *
+ * @param range_jump range step between two points of an object [m]
+ * @param angular_gap missing beams bridged inside an object [deg]
+ * @param min_points smallest cluster kept
+ * @param channels grid channels
+ * @param beams grid beams per channel
+ * @param h_resolution horizontal angle between two beams [deg]
+ */
+kanavi_cluster::kanavi_cluster(float range_jump, float angular_gap, int min_points, int channels, int beams, double h_resolution)
+	: range_jump_(range_jump), angular_gap_(angular_gap), max_gap_(0), min_points_(min_points), beams_(beams),
+	  used_(0), prev_ch_(-1)
+{
+	if (!(range_jump > 0))
+	{
+		throw std::runtime_error("Invalid cluster range jump : " + std::to_string(range_jump));
+	}
+	if (!(angular_gap >= 0))
+	{
+		throw std::runtime_error("Invalid cluster angular gap : " + std::to_string(angular_gap));
+	}
+	if (min_points < 1)
+	{
+		throw std::runtime_error("Invalid cluster min points : " + std::to_string(min_points));
+	}
+	if (channels <= 0 || beams <= 0 || !(h_resolution > 0))
+	{
+		throw std::runtime_error("Invalid cluster grid : " + std::to_string(channels) + " x " + std::to_string(beams));
+	}
+	max_gap_ = static_cast<int>(std::floor(angular_gap / h_resolution + 1e-6));
+
+	// worst case : one segment per point
+	size_t capacity = static_cast<size_t>(channels) * beams;
+	parent_.resize(capacity);
+	count_.resize(capacity);
+	sum_.resize(capacity * 3);
+	min_.resize(capacity * 3);
+	max_.resize(capacity * 3);
+
+	prev_segment_.assign(beams, NONE);
+	prev_len_.assign(beams, 0);
+	cur_segment_.assign(beams, NONE);
+	cur_len_.assign(beams, 0);
+
+	clusters_.reserve(capacity);
+}
+
+kanavi_cluster::~kanavi_cluster()
+{
+}
+
+void kanavi_cluster::clear()
+{
+	used_ = 0;
+	prev_ch_ = -1;
+	clusters_.clear();
+}
+
+uint32_t kanavi_cluster::find(uint32_t s)
+{
+	while (parent_[s] != s)
+	{
+		parent_[s] = parent_[parent_[s]];
+		s = parent_[s];
+	}
+	return s;
+}
+
+void kanavi_cluster::insert(int ch, const float *x, const float *y, const float *z, const float *len, const uint8_t *valid, int count)
+{
+	count = std::min(count, beams_);
+	bool merge = (prev_ch_ >= 0 && ch == prev_ch_ + 1);
+
+	uint32_t segment = NONE;
+	int last_beam = 0;
+	float last_len = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		float r = len[i];
+		if ((valid && !valid[i]) || !(r > 0))
+		{
+			cur_segment_[i] = NONE;
+			continue;
+		}
+
+		// along the ring : range step and missing beams
+		if (segment == NONE || i - last_beam - 1 > max_gap_ || std::fabs(r - last_len) > range_jump_)
+		{
+			segment = used_++;
+			parent_[segment] = segment;
+			count_[segment] = 0;
+			float *s = &sum_[segment * 3];
+			float *lo = &min_[segment * 3];
+			float *hi = &max_[segment * 3];
+			s[0] = s[1] = s[2] = 0;
+			lo[0] = lo[1] = lo[2] = FLT_MAX;
+			hi[0] = hi[1] = hi[2] = -FLT_MAX;
+		}
+
+		// across the rings : same beam of the previous ring, the older root is kept
+		if (merge && prev_segment_[i] != NONE && std::fabs(r - prev_len_[i]) <= range_jump_)
+		{
+			uint32_t a = find(segment);
+			uint32_t b = find(prev_segment_[i]);
+			if (a != b)
+			{
+				parent_[std::max(a, b)] = std::min(a, b);
+			}
+		}
+
+		count_[segment]++;
+		float *s = &sum_[segment * 3];
+		float *lo = &min_[segment * 3];
+		float *hi = &max_[segment * 3];
+		s[0] += x[i];
+		s[1] += y[i];
+		s[2] += z[i];
+		lo[0] = std::min(lo[0], x[i]);
+		lo[1] = std::min(lo[1], y[i]);
+		lo[2] = std::min(lo[2], z[i]);
+		hi[0] = std::max(hi[0], x[i]);
+		hi[1] = std::max(hi[1], y[i]);
+		hi[2] = std::max(hi[2], z[i]);
+
+		cur_segment_[i] = segment;
+		cur_len_[i] = r;
+		last_beam = i;
+		last_len = r;
+	}
+	std::fill(cur_segment_.begin() + count, cur_segment_.end(), NONE);
+
+	prev_segment_.swap(cur_segment_);
+	prev_len_.swap(cur_len_);
+	prev_ch_ = ch;
+}
+
+void kanavi_cluster::finish()
+{
+	clusters_.clear();
+
+	// roots are the first segment of their cluster, a merged segment always follows its root
+	for (uint32_t seg = 0; seg < used_; seg++)
+	{
+		uint32_t root = find(seg);
+		if (root == seg)
+		{
+			continue;
+		}
+		count_[root] += count_[seg];
+		for (int k = 0; k < 3; k++)
+		{
+			sum_[root * 3 + k] += sum_[seg * 3 + k];
+			min_[root * 3 + k] = std::min(min_[root * 3 + k], min_[seg * 3 + k]);
+			max_[root * 3 + k] = std::max(max_[root * 3 + k], max_[seg * 3 + k]);
+		}
+	}
+
+	for (uint32_t seg = 0; seg < used_; seg++)
+	{
+		if (parent_[seg] != seg || count_[seg] < static_cast<uint32_t>(min_points_))
+		{
+			continue;
+		}
+
+		KANAVI::CLUSTER::cluster c;
+		float inv = 1.0f / static_cast<float>(count_[seg]);
+		for (int k = 0; k < 3; k++)
+		{
+			c.centroid[k] = sum_[seg * 3 + k] * inv;
+			c.min[k] = min_[seg * 3 + k];
+			c.max[k] = max_[seg * 3 + k];
+		}
+		c.count = count_[seg];
+		clusters_.push_back(c);
+	}
+}
@@ -0,0 +1,271 @@
+#include "kanavi_codec.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const float CM_PER_M = 100.0f;
+	const float RANGE_MAX_CM = 65535.0f;
+	const uint32_t GRID_MAX = 1u << 20;	// beams of a frame, sanity limit of the decoder
+
+	inline uint32_t zigzag(int32_t v)
+	{
+		return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+	}
+
+	inline int32_t unzigzag(uint32_t v)
+	{
+		return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+	}
+
+	inline void putVarint(std::vector<uint8_t> &out, uint32_t v)
+	{
+		while (v >= 0x80)
+		{
+			out.push_back(static_cast<uint8_t>(v | 0x80));
+			v >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(v));
+	}
+
+	inline bool getVarint(const uint8_t *&p, const uint8_t *end, uint32_t &v)
+	{
+		v = 0;
+		for (int shift = 0; shift < 35 && p < end; shift += 7)
+		{
+			uint8_t b = *p++;
+			v |= static_cast<uint32_t>(b & 0x7F) << shift;
+			if (!(b & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+/**
+ * @brief Construct a new kanavi delta encoder::kanavi delta encoder object
+ *
+ * @param channels grid channels
+ * @param beams grid beams per channel
+ * @param threshold range change sent in a delta [m]
+ * @param interval frames between two keyframes
+ */
+kanavi_delta_encoder::kanavi_delta_encoder(int channels, int beams, float threshold, int interval)
+	: channels_(channels), beams_(beams), threshold_(0), interval_(interval),
+	  sequence_(0), since_keyframe_(interval), keyframe_(false), force_keyframe_(true)
+{
+	if (channels <= 0 || beams <= 0)
+	{
+		throw std::runtime_error("Invalid codec grid : " + std::to_string(channels) + " x " + std::to_string(beams));
+	}
+	if (!(threshold >= 0))
+	{
+		throw std::runtime_error("Invalid codec threshold : " + std::to_string(threshold));
+	}
+	if (interval < 1)
+	{
+		throw std::runtime_error("Invalid codec keyframe interval : " + std::to_string(interval));
+	}
+	threshold_ = static_cast<uint16_t>(std::min(threshold * CM_PER_M + 0.5f, RANGE_MAX_CM));
+
+	size_t total = static_cast<size_t>(channels_) * beams_;
+	reference_.assign(total, 0);
+	current_.assign(total, 0);
+
+	// worst case : every beam as a 3 byte varint plus one run header
+	out_.reserve(total * 3 + 32);
+}
+
+kanavi_delta_encoder::~kanavi_delta_encoder()
+{
+}
+
+void kanavi_delta_encoder::writeHeader(uint8_t type)
+{
+	out_.push_back(KANAVI::CODEC::VERSION);
+	out_.push_back(type);
+	putVarint(out_, sequence_);
+	putVarint(out_, static_cast<uint32_t>(channels_));
+	putVarint(out_, static_cast<uint32_t>(beams_));
+}
+
+const std::vector<uint8_t> &kanavi_delta_encoder::encode(const std::vector< std::vector<float> > &len_buf)
+{
+	// [m] -> [cm], missing rows count as no return
+	std::fill(current_.begin(), current_.end(), 0);
+	int channels = std::min(static_cast<int>(len_buf.size()), channels_);
+	for (int ch = 0; ch < channels; ch++)
+	{
+		const std::vector<float> &len = len_buf[ch];
+		int count = std::min(static_cast<int>(len.size()), beams_);
+		uint16_t *cur = current_.data() + static_cast<size_t>(ch) * beams_;
+		for (int i = 0; i < count; i++)
+		{
+			cur[i] = static_cast<uint16_t>(std::min(std::max(len[i], 0.0f) * CM_PER_M + 0.5f, RANGE_MAX_CM));
+		}
+	}
+
+	keyframe_ = force_keyframe_ || since_keyframe_ >= interval_;
+	force_keyframe_ = false;
+	since_keyframe_ = keyframe_ ? 1 : since_keyframe_ + 1;
+
+	out_.clear();
+	writeHeader(keyframe_ ? KANAVI::CODEC::KEYFRAME : KANAVI::CODEC::DELTA);
+	sequence_++;
+
+	const size_t total = current_.size();
+	const uint16_t *cur = current_.data();
+	uint16_t *ref = reference_.data();
+
+	if (keyframe_)
+	{
+		// neighbouring beams see similar ranges, their difference is mostly 1 byte
+		int32_t prev = 0;
+		for (size_t i = 0; i < total; i++)
+		{
+			putVarint(out_, zigzag(static_cast<int32_t>(cur[i]) - prev));
+			prev = cur[i];
+		}
+		std::copy(current_.begin(), current_.end(), reference_.begin());
+		return out_;
+	}
+
+	size_t i = 0;
+	while (i < total)
+	{
+		size_t start = i;
+		while (i < total && std::abs(static_cast<int32_t>(cur[i]) - ref[i]) <= threshold_)
+		{
+			i++;
+		}
+		if (i == total)
+		{
+			break;
+		}
+
+		// a single unchanged beam inside a run is cheaper to send than a new run header
+		size_t run_start = i;
+		while (i < total)
+		{
+			if (std::abs(static_cast<int32_t>(cur[i]) - ref[i]) > threshold_)
+			{
+				i++;
+			}
+			else if (i + 1 < total && std::abs(static_cast<int32_t>(cur[i + 1]) - ref[i + 1]) > threshold_)
+			{
+				i += 2;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		putVarint(out_, static_cast<uint32_t>(run_start - start));
+		putVarint(out_, static_cast<uint32_t>(i - run_start));
+		for (size_t k = run_start; k < i; k++)
+		{
+			putVarint(out_, zigzag(static_cast<int32_t>(cur[k]) - ref[k]));
+			ref[k] = cur[k];
+		}
+	}
+
+	return out_;
+}
+
+kanavi_delta_decoder::kanavi_delta_decoder()
+	: channels_(0), beams_(0), sequence_(0), synced_(false)
+{
+}
+
+kanavi_delta_decoder::~kanavi_delta_decoder()
+{
+}
+
+int kanavi_delta_decoder::decode(const uint8_t *data, size_t size)
+{
+	if (!data || size < 2 || data[0] != KANAVI::CODEC::VERSION)
+	{
+		return KANAVI::CODEC::DecodeResult::FAIL;
+	}
+
+	const uint8_t *p = data + 2;
+	const uint8_t *end = data + size;
+	uint8_t type = data[1];
+
+	uint32_t sequence, channels, beams;
+	if (!getVarint(p, end, sequence) || !getVarint(p, end, channels) || !getVarint(p, end, beams) ||
+		channels == 0 || beams == 0 || static_cast<uint64_t>(channels) * beams > GRID_MAX)
+	{
+		return KANAVI::CODEC::DecodeResult::FAIL;
+	}
+	size_t total = static_cast<size_t>(channels) * beams;
+
+	if (type == KANAVI::CODEC::KEYFRAME)
+	{
+		channels_ = static_cast<int>(channels);
+		beams_ = static_cast<int>(beams);
+		grid_.resize(total);
+		range_.resize(total);
+
+		int32_t prev = 0;
+		for (size_t i = 0; i < total; i++)
+		{
+			uint32_t v;
+			if (!getVarint(p, end, v))
+			{
+				synced_ = false;
+				return KANAVI::CODEC::DecodeResult::FAIL;
+			}
+			prev += unzigzag(v);
+			grid_[i] = static_cast<uint16_t>(std::min(std::max(prev, 0), 65535));
+			range_[i] = grid_[i] * (1.0f / CM_PER_M);
+		}
+	}
+	else if (type == KANAVI::CODEC::DELTA)
+	{
+		// a lost frame leaves the reference behind the encoder
+		if (!synced_ || sequence != sequence_ + 1 || static_cast<int>(channels) != channels_ || static_cast<int>(beams) != beams_)
+		{
+			synced_ = false;
+			return KANAVI::CODEC::DecodeResult::NEED_KEYFRAME;
+		}
+
+		size_t i = 0;
+		while (i < total && p < end)
+		{
+			uint32_t skip, run;
+			if (!getVarint(p, end, skip) || !getVarint(p, end, run) || skip > total - i || run > total - i - skip)
+			{
+				synced_ = false;
+				return KANAVI::CODEC::DecodeResult::FAIL;
+			}
+			i += skip;
+			for (uint32_t k = 0; k < run; k++, i++)
+			{
+				uint32_t v;
+				if (!getVarint(p, end, v))
+				{
+					synced_ = false;
+					return KANAVI::CODEC::DecodeResult::FAIL;
+				}
+				int32_t r = static_cast<int32_t>(grid_[i]) + unzigzag(v);
+				grid_[i] = static_cast<uint16_t>(std::min(std::max(r, 0), 65535));
+				range_[i] = grid_[i] * (1.0f / CM_PER_M);
+			}
+		}
+	}
+	else
+	{
+		return KANAVI::CODEC::DecodeResult::FAIL;
+	}
+
+	sequence_ = sequence;
+	synced_ = true;
+	return KANAVI::CODEC::DecodeResult::SUCCESS;
+}
@@ -0,0 +1,9 @@
+#if defined(ROS2)
+
+#include <ros2/kanavi_node.h>
+#include <rclcpp_components/register_node_macro.hpp>
+
+// kanavi_node as a composable node : the model & options are node parameters
+RCLCPP_COMPONENTS_REGISTER_NODE(kanavi_node)
+
+#endif
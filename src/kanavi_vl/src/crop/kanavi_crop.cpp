@@ -0,0 +1,126 @@
+#include "kanavi_crop.h"
+#include "kanavi_projection.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	// wrap-around window, [min, max] measured counter-clockwise from min
+	bool inWindow(float azimuth, float min, float max)
+	{
+		float width = max - min;
+		if (width >= 360)
+		{
+			return true;
+		}
+		if (width < 0)
+		{
+			width += 360.0f;	// window across +-180
+		}
+		float d = std::fmod(azimuth - min, 360.0f);
+		if (d < 0)
+		{
+			d += 360.0f;
+		}
+		return d <= width;
+	}
+}
+
+/**
+ * @brief Construct a new kanavi crop::kanavi crop object
+ *
+ * @param cfg crop settings
+ * @param projection direction / offset tables of the points
+ */
+kanavi_crop::kanavi_crop(const KANAVI::CROP::config &cfg, const kanavi_projection &projection)
+	: channels_(projection.getChannels()), beams_(projection.getBeams())
+{
+	size_t total = static_cast<size_t>(channels_) * beams_;
+	lo_.assign(total, 1);
+	hi_.assign(total, 0);
+	enabled_.assign(channels_, 0);
+
+	for (int ch = 0; ch < channels_; ch++)
+	{
+		if (!cfg.channels.empty() && std::find(cfg.channels.begin(), cfg.channels.end(), ch) == cfg.channels.end())
+		{
+			continue;
+		}
+
+		const float *dir[3] = {projection.dirX(ch), projection.dirY(ch), projection.dirZ(ch)};
+		const float *off[3] = {projection.offsetX(ch), projection.offsetY(ch), projection.offsetZ(ch)};
+
+		for (int i = 0; i < beams_; i++)
+		{
+			if (!inWindow(projection.getAzimuth(i), cfg.azimuth_min, cfg.azimuth_max))
+			{
+				continue;
+			}
+
+			// lo > 0 : zero returns never pass
+			double lo = std::max(cfg.range_min, FLT_MIN);
+			double hi = cfg.range_max;
+
+			// point = r * d + o, each box slab bounds r on this beam
+			for (int a = 0; cfg.box && a < 3; a++)
+			{
+				double d = dir[a][i];
+				double o = off[a] ? off[a][i] : 0;
+				if (std::fabs(d) < 1e-9)
+				{
+					if (o < cfg.box_min[a] || o > cfg.box_max[a])
+					{
+						hi = -1;
+					}
+					continue;
+				}
+				double t0 = (cfg.box_min[a] - o) / d;
+				double t1 = (cfg.box_max[a] - o) / d;
+				lo = std::max(lo, std::min(t0, t1));
+				hi = std::min(hi, std::max(t0, t1));
+			}
+
+			if (lo > hi)
+			{
+				continue;
+			}
+
+			size_t idx = static_cast<size_t>(ch) * beams_ + i;
+			lo_[idx] = static_cast<float>(lo);
+			hi_[idx] = static_cast<float>(hi);
+			enabled_[ch] = 1;
+		}
+	}
+}
+
+kanavi_crop::~kanavi_crop()
+{
+}
+
+int kanavi_crop::mask(const float *len, int ch, int count, uint8_t *valid) const
+{
+	if (!isChannelEnabled(ch))
+	{
+		std::fill(valid, valid + count, 0);
+		return 0;
+	}
+	if (count > beams_)
+	{
+		count = beams_;
+	}
+
+	const float *lo = lo_.data() + static_cast<size_t>(ch) * beams_;
+	const float *hi = hi_.data() + static_cast<size_t>(ch) * beams_;
+
+	// branchless, vectorized by the compiler
+	int accepted = 0;
+	for (int i = 0; i < count; i++)
+	{
+		uint8_t keep = static_cast<uint8_t>((len[i] >= lo[i]) & (len[i] <= hi[i]));
+		valid[i] = keep;
+		accepted += keep;
+	}
+	return accepted;
+}
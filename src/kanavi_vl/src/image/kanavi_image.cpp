@@ -0,0 +1,62 @@
+#include "kanavi_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief Construct a new kanavi image::kanavi image object
+ *
+ * @param unit pixel unit ref include/kanavi_image.h
+ * @param channels image height
+ * @param beams image width
+ */
+kanavi_image::kanavi_image(const std::string &unit, int channels, int beams)
+	: unit_(unit), scale_(0), height_(channels), width_(beams)
+{
+	if (unit_ == KANAVI::IMAGE::UNIT_CM)
+	{
+		scale_ = 100;
+	}
+	else if (unit_ == KANAVI::IMAGE::UNIT_MM)
+	{
+		scale_ = 1000;
+	}
+	else
+	{
+		throw std::runtime_error("Invalid range image unit : " + unit_);
+	}
+}
+
+kanavi_image::~kanavi_image()
+{
+}
+
+void kanavi_image::write(uint8_t *dst, const std::vector<std::vector<float>> &len_buf) const
+{
+	// quantize in float, 65535 counts is the top of the unit range
+	const float limit = static_cast<float>(KANAVI::IMAGE::SATURATED);
+
+	for (int ch = 0; ch < height_; ch++)
+	{
+		uint16_t *row = reinterpret_cast<uint16_t *>(dst + static_cast<size_t>(ch) * getStep());
+
+		int cnt = 0;
+		if (ch < static_cast<int>(len_buf.size()))
+		{
+			const std::vector<float> &len_ = len_buf[ch];
+			cnt = std::min(static_cast<int>(len_.size()), width_);
+
+			for (int i = 0; i < cnt; i++)
+			{
+				float v = len_[i] * scale_ + 0.5f;
+				row[i] = (v >= limit) ? KANAVI::IMAGE::SATURATED : static_cast<uint16_t>(v);
+			}
+		}
+
+		if (cnt < width_)
+		{
+			memset(row + cnt, 0, static_cast<size_t>(width_ - cnt) * sizeof(uint16_t));
+		}
+	}
+}
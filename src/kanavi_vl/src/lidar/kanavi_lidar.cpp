@@ -1,4 +1,7 @@
 #include "kanavi_lidar.h"
+#include "kanavi_log.h"
+
+#include <algorithm>
 
 /**
  * @brief Construct a new kanavi lidar::kanavi lidar object
@@ -7,7 +10,6 @@
  */
 kanavi_lidar::kanavi_lidar(int model_)
 {
-<<<<<<< HEAD
 	datagram_ = nullptr;
 	try {
 		datagram_ = new kanaviDatagram(model_);
@@ -23,6 +25,10 @@ kanavi_lidar::kanavi_lidar(int model_)
 		checked_model = -1;
 		total_size = 0;
 
+		checked_channel_end = false;
+		last_channel = -1;
+		checked_status_changed = false;
+
 		// Initialize vectors based on model
 		switch (model_)
 		{
@@ -58,18 +64,6 @@ kanavi_lidar::kanavi_lidar(int model_)
 		}
 		throw;
 	}
-=======
-	datagram_ = new kanaviDatagram(model_);
-	checked_onGoing = false;
-	checked_pares_end = false;
-	memset(checked_ch_r4, false, 4);
-
-	checked_ch0_inputed = false;
-
-	checked_model = -1;
-
-	total_size = 0;
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
 }
 
 /**
@@ -78,14 +72,11 @@ kanavi_lidar::kanavi_lidar(int model_)
  */
 kanavi_lidar::~kanavi_lidar()
 {
-<<<<<<< HEAD
 	if (datagram_ != nullptr)
 	{
 		delete datagram_;
 		datagram_ = nullptr;
 	}
-=======
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
 }
 
 /**
@@ -102,13 +93,13 @@ int kanavi_lidar::classification(const std::vector<u_char> &data)
 		switch (indus_M)
 		{
 		case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-			printf("********R2**********\n");
+			KANAVI_LOG_DEBUG("********R2**********\n");
 			return KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2;
 		case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-			printf("********R4**********\n");
+			KANAVI_LOG_DEBUG("********R4**********\n");
 			return KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4;
 		case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
-			printf("********R270**********\n");
+			KANAVI_LOG_DEBUG("********R270**********\n");
 			return KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270;
 		default:
 			return -1;
@@ -120,104 +111,65 @@ int kanavi_lidar::classification(const std::vector<u_char> &data)
 
 int kanavi_lidar::process(const std::vector<u_char> &data)
 {
-<<<<<<< HEAD
 	if (!datagram_) {
-		printf("[LiDAR] Datagram is not initialized\n");
-		return -1;
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Datagram is not initialized\n");
+		return KANAVI::PROCESS::InputMode::FAIL;
 	}
 
 	if (data.empty()) {
-		printf("[LiDAR] Empty data received\n");
-		return -1;
-	}
-
-	// header value Check in data
-	if ((data[KANAVI::COMMON::PROTOCOL_POS::HEADER] & 0xFF) != KANAVI::COMMON::PROTOCOL_VALUE::HEADER) {
-		printf("[LiDAR] Invalid header\n");
-		return -1;
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Empty data received\n");
+		return KANAVI::PROCESS::InputMode::FAIL;
 	}
 
-	// u_char ch_ = data[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
-	u_char mode = data[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::MODE)];
-
-	// check Model
-	if (!checked_ch0_inputed) {
-		checked_model = classification(data);
-		if (checked_model == -1) {
-			printf("[LiDAR] Classification Error!\n");
-			return -1;
-		}
-
-		if (checked_model != datagram_->model) {
-			printf("[LiDAR] Model not Matched\n");
-			return -1;
-		}
-		checked_ch0_inputed = true;
-	}
+	checked_channel_end = false;
+	last_channel = -1;
+	checked_status_changed = false;
 
-	// Process data based on mode
-	if (mode == KANAVI::COMMON::PROTOCOL_VALUE::COMMAND::MODE::DISTANCE_DATA) {
-		printf("---------KANAVI PROCESS------------\n");
-		
-		try {
-			// Process the data directly
-			switch (checked_model) {
-				case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-					r2(data, datagram_);
-					break;
-				case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-					r4(data, datagram_);
-					break;
-				case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
-					r270(data, datagram_);
-					break;
-				default:
-					printf("[LiDAR] Unknown model\n");
-					return -1;
-			}
-			
-			checked_pares_end = true;
-			return 1;
-		} catch (const std::exception& e) {
-			printf("[LiDAR] Error in process: %s\n", e.what());
-			return -1;
-		}
-	}
-
-	return 0;
-=======
 	// r270데이터가 끊어져서 들어오므로 합칠 필요가 있음.
-	// hedaer checker
-	bool checked_h = false;
-
 	// header value Check in data
 	if ((data[KANAVI::COMMON::PROTOCOL_POS::HEADER] & 0xFF) == KANAVI::COMMON::PROTOCOL_VALUE::HEADER)
 	{
-		checked_h = true;
+		// every header field below is read from the command header
+		if (data.size() < static_cast<size_t>(KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START))
+		{
+			KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Packet shorter than the command header: %zu\n", data.size());
+			return KANAVI::PROCESS::InputMode::FAIL;
+		}
 
 		u_char ch_ = data[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
 
+		// config responses are never part of a distance frame
+		if (data[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::MODE)] == KANAVI::COMMON::PROTOCOL_VALUE::COMMAND::MODE::CONFIG_SET &&
+			data[KANAVI::COMMON::PROTOCOL_POS::PRODUCT_LINE] == datagram_->model)
+		{
+			if (ch_ == static_cast<u_char>(KANAVI::COMMON::PROTOCOL_VALUE::COMMAND::PARAMETER::RECV::LOAD_EXIST_SET_DATA))
+			{
+				parseAreaConfig(data);
+			}
+			return KANAVI::PROCESS::InputMode::OnGoing;
+		}
+
 		// check Model
 		if (!checked_ch0_inputed)
 		{
 			checked_model = classification(data);
 			if (checked_model == -1)
 			{
-				perror("LiDAR Classification Error!");
-				return -1;
+				KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Classification Error!\n");
+				return KANAVI::PROCESS::InputMode::FAIL;
 			}
 
 			// check Model, one more time
 			if (checked_model != datagram_->model)
 			{
-				perror("LiDAR Model not Matched");
-				return -1;
+				KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Model not Matched\n");
+				return KANAVI::PROCESS::InputMode::FAIL;
 			}
 		}
 
 		if (ch_ == KANAVI::COMMON::PROTOCOL_VALUE::CHANNEL::CHANNEL_0)
 		{
-			printf("---------KANAVI PROCESS------------\n");
+			KANAVI_LOG_DEBUG("---------KANAVI PROCESS------------\n");
 
 			checked_ch0_inputed = true;
 			checked_pares_end = false;
@@ -225,16 +177,13 @@ int kanavi_lidar::process(const std::vector<u_char> &data)
 			switch (checked_model)
 			{
 			case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-				/* code */
-				total_size = KANAVI::R2::DATASIZE * 2;
+				total_size = KANAVI::R2::DATASIZE * KANAVI::R2::VERTICAL_CHANNEL;
 				break;
 			case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
 				total_size = KANAVI::R270::DATASIZE;
-				/* code */
 				break;
 			case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-				total_size = KANAVI::R4::DATASIZE * 4;
-				/* code */
+				total_size = KANAVI::R4::DATASIZE * KANAVI::R4::VERTICAL_CHANNEL;
 				break;
 			default:
 				break;
@@ -242,20 +191,43 @@ int kanavi_lidar::process(const std::vector<u_char> &data)
 		}
 	}
 
-	if (checked_ch0_inputed)
+	if (!checked_ch0_inputed)
 	{
-		// 0번 채널이 들어온 이후부터 데이터 축적
-		temp_buf_.insert(temp_buf_.end(), data.begin(), data.end());
-		printf("[LiDAR] Processing...\n");
+		return KANAVI::PROCESS::InputMode::OnGoing;
 	}
 
-	// 채널이 많으면 채널을 확인해서 전부 취합되었는지 확인
+	// 0번 채널이 들어온 이후부터 데이터 축적
+	temp_buf_.insert(temp_buf_.end(), data.begin(), data.end());
+	KANAVI_LOG_DEBUG("[LiDAR] Processing...\n");
+
+	// multi-channel models : decode each channel as soon as its packet is complete
+	switch (checked_model)
+	{
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
+		if (temp_buf_.size() % KANAVI::R2::DATASIZE == 0)
+		{
+			parseChunk(temp_buf_, KANAVI::R2::DATASIZE);
+		}
+		break;
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
+		if (temp_buf_.size() % KANAVI::R4::DATASIZE == 0)
+		{
+			parseChunk(temp_buf_, KANAVI::R4::DATASIZE);
+		}
+		break;
+	default:
+		break;
+	}
+
+	// 프레임이 전부 취합되었는지 확인
 	if (temp_buf_.size() == total_size)
 	{
 		parse(temp_buf_);
 		checked_ch0_inputed = false;
+		return KANAVI::PROCESS::InputMode::SUCCESS;
 	}
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
+
+	return KANAVI::PROCESS::InputMode::OnGoing;
 }
 
 std::string kanavi_lidar::getLiDARModel()
@@ -265,65 +237,49 @@ std::string kanavi_lidar::getLiDARModel()
 
 void kanavi_lidar::parse(const std::vector<u_char> &data)
 {
-<<<<<<< HEAD
 	if (data.size() < KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START)
 	{
-		printf("[LiDAR] Invalid data size\n");
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid data size\n");
 		return;
 	}
 
 	switch (datagram_->model)
 	{
 	case KANAVI::COMMON::PROTOCOL_VALUE::R2:
-		r2(data, datagram_);
-		break;
 	case KANAVI::COMMON::PROTOCOL_VALUE::R4:
-		r4(data, datagram_);
-=======
+		// multi-channel frames are already decoded per channel, see parseChunk()
+		break;
+	case KANAVI::COMMON::PROTOCOL_VALUE::R270:
+		r270(data.data(), data.size(), datagram_);
+		break;
+	}
+}
+
+void kanavi_lidar::parseChunk(const std::vector<u_char> &data, size_t chunk_size)
+{
+	if (data.size() < chunk_size)
+	{
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Not enough data for chunk\n");
+		return;
+	}
+
+	// newest channel packet is the tail of the frame buffer, read in place
+	const u_char *chunk = data.data() + (data.size() - chunk_size);
+
 	switch (datagram_->model)
 	{
 	case KANAVI::COMMON::PROTOCOL_VALUE::R2:
-		for (int i = 0; i < 2; i++)
-		{
-			auto start = data.begin() + i * KANAVI::R2::DATASIZE;
-			auto end = start + KANAVI::R2::DATASIZE;
-
-			if (end <= data.end())
-			{ // 벡터 범위 체크
-				r2(std::vector<u_char>(start, end), datagram_);
-			}
-			else
-			{
-				// 데이터 부족 시 처리 로직
-				std::cerr << "Not enough data for chunk " << i << std::endl;
-			}
-		}
+		r2(chunk, chunk_size, datagram_);
 		break;
 	case KANAVI::COMMON::PROTOCOL_VALUE::R4:
-		for (int i = 0; i < 4; i++)
-		{
-			auto start = data.begin() + i * KANAVI::R4::DATASIZE;
-			auto end = start + KANAVI::R4::DATASIZE;
-
-			if (end <= data.end())
-			{ // 벡터 범위 체크
-				r4(std::vector<u_char>(start, end), datagram_);
-			}
-			else
-			{
-				// 데이터 부족 시 처리 로직
-				std::cerr << "Not enough data for chunk " << i << std::endl;
-			}
-		}
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
+		r4(chunk, chunk_size, datagram_);
 		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::R270:
-		r270(data, datagram_);
+	default:
 		break;
 	}
 }
 
-void kanavi_lidar::r2(const std::vector<u_char> &input, kanaviDatagram *output)
+void kanavi_lidar::r2(const u_char *input, size_t size, kanaviDatagram *output)
 {
 	// u_char mode = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::MODE)];
 	// u_char ch = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
@@ -339,53 +295,35 @@ void kanavi_lidar::r2(const std::vector<u_char> &input, kanaviDatagram *output)
 	// 			output->h_resolution = KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION;
 	// 		}
 	// 	}
-	// 	parseLength(input, output, static_cast<int>(ch & 0x0F)); // convert byte to length
+	// 	parseLength(input, size, output, static_cast<int>(ch & 0x0F)); // convert byte to length
 	// }
 }
 
-void kanavi_lidar::r4(const std::vector<u_char> &input, kanaviDatagram *output)
+void kanavi_lidar::r4(const u_char *input, size_t size, kanaviDatagram *output)
 {
-<<<<<<< HEAD
 	if (!output) {
-		printf("[LiDAR] Invalid output pointer in r4\n");
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid output pointer in r4\n");
 		return;
 	}
 
-	if (input.size() < KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START) {
-		printf("[LiDAR] Invalid input size in r4\n");
+	if (size < KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START) {
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid input size in r4\n");
 		return;
 	}
 
-	try {
-		u_char ch = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
+	u_char mode = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::MODE)];
+	u_char ch = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
+
+	if (mode == KANAVI::COMMON::PROTOCOL_VALUE::COMMAND::MODE::DISTANCE_DATA)
+	{
 		int channel = static_cast<int>(ch & 0x0F);
 
 		// Validate channel number
 		if (channel >= KANAVI::R4::VERTICAL_CHANNEL) {
-			printf("[LiDAR] Invalid channel number: %d\n", channel);
+			KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid channel number: %d\n", channel);
 			return;
 		}
 
-		// Ensure len_buf is properly initialized
-		if (output->len_buf.empty()) {
-			printf("[LiDAR] len_buf not properly initialized for channel %d\n", channel);
-			return;
-		}
-
-		// set specification for any channel
-		output->v_resolution = KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION;
-		output->h_resolution = KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION;
-
-		// process the current channel data
-		parseLength(input, output, channel);
-	} catch (const std::exception& e) {
-		printf("[LiDAR] Error in r4: %s\n", e.what());
-=======
-	u_char mode = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::MODE)];
-	u_char ch = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
-
-	if (mode == KANAVI::COMMON::PROTOCOL_VALUE::COMMAND::MODE::DISTANCE_DATA)
-	{
 		// check ch 0 data input
 		if (ch == KANAVI::COMMON::PROTOCOL_VALUE::CHANNEL::CHANNEL_0)
 		{
@@ -395,13 +333,16 @@ void kanavi_lidar::r4(const std::vector<u_char> &input, kanaviDatagram *output)
 				output->h_resolution = KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION;
 			}
 		}
-		// printf("[LiDAR] Process CH : %d\n", ch & 0x0F);
-		checked_ch_r4[ch & 0x0F] = true;
-		parseLength(input, output, static_cast<int>(ch & 0x0F)); // convert byte to length
+		checked_ch_r4[channel] = true;
+		parseLength(input, size, output, channel); // convert byte to length
+		parseDetection(input, size);
+
+		// this channel can be streamed right away
+		checked_channel_end = true;
+		last_channel = channel;
 
 		if (ch == KANAVI::COMMON::PROTOCOL_VALUE::CHANNEL::CHANNEL_3)
 		{
-			// checked_onGoing = true;
 			if (checked_ch_r4[0] && checked_ch_r4[1] && checked_ch_r4[2] && checked_ch_r4[3])
 			{
 				memset(checked_ch_r4, false, 4);
@@ -410,14 +351,13 @@ void kanavi_lidar::r4(const std::vector<u_char> &input, kanaviDatagram *output)
 			else
 			{
 				memset(checked_ch_r4, false, 4);
-				printf("[LiDAR] Align ERROR#####\n");
+				KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Align ERROR#####\n");
 			}
 		}
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
 	}
 }
 
-void kanavi_lidar::r270(const std::vector<u_char> &input, kanaviDatagram *output)
+void kanavi_lidar::r270(const u_char *input, size_t size, kanaviDatagram *output)
 {
 	u_char mode = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::MODE)];
 	u_char ch = input[static_cast<int>(KANAVI::COMMON::PROTOCOL_POS::COMMAND::PARAMETER)];
@@ -433,49 +373,51 @@ void kanavi_lidar::r270(const std::vector<u_char> &input, kanaviDatagram *output
 				output->h_resolution = KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION;
 			}
 
-			parseLength(input, output, static_cast<int>(ch & 0x0F)); // convert byte to length
+			parseLength(input, size, output, static_cast<int>(ch & 0x0F)); // convert byte to length
+			parseDetection(input, size);
 			checked_pares_end = true;
 		}
 	}
 }
 
-void kanavi_lidar::parseLength(const std::vector<u_char> &input, kanaviDatagram *output, int ch)
+void kanavi_lidar::parseLength(const u_char *input, size_t size, kanaviDatagram *output, int ch)
 {
-<<<<<<< HEAD
 	if (!output) {
-		printf("[LiDAR] Invalid output pointer in parseLength\n");
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid output pointer in parseLength\n");
 		return;
 	}
 
 	if (ch >= KANAVI::R4::VERTICAL_CHANNEL) {
-		printf("[LiDAR] Invalid channel number: %d\n", ch);
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid channel number: %d\n", ch);
 		return;
 	}
 
 	if (static_cast<size_t>(ch) >= output->len_buf.size()) {
-		printf("[LiDAR] Channel index out of range: %d\n", ch);
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Channel index out of range: %d\n", ch);
 		return;
 	}
 
 	try {
 		// Calculate expected size
+		// ranges are followed by the detection byte and the checksum
 		int start = KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START;
-		int end = input.size() - KANAVI::COMMON::PROTOCOL_SIZE::CHECKSUM;
+		int end = static_cast<int>(size) - KANAVI::COMMON::PROTOCOL_POS::CHECKSUM - KANAVI::COMMON::PROTOCOL_SIZE::DITECTION;
 		int expected_size = (end - start) / 2;
 
 		if (expected_size <= 0) {
-			printf("[LiDAR] Invalid data size: start=%d, end=%d\n", start, end);
+			KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid data size: start=%d, end=%d\n", start, end);
 			return;
 		}
 
-		// Create new vector with proper size
-		std::vector<float> len_;
+		// rewritten in place, the capacity reserved for the model is kept
+		std::vector<float> &len_ = output->len_buf[ch];
+		len_.clear();
 		len_.reserve(expected_size);
 
 		// Process data
 		for (int i = start; i < end; i += 2) {
-			if (i + 1 >= static_cast<int>(input.size())) {
-				printf("[LiDAR] Data size error at index %d\n", i);
+			if (i + 1 >= static_cast<int>(size)) {
+				KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Data size error at index %d\n", i);
 				break;
 			}
 			float up = input[i];
@@ -486,35 +428,44 @@ void kanavi_lidar::parseLength(const std::vector<u_char> &input, kanaviDatagram
 
 		// Verify the processed data
 		if (len_.empty()) {
-			printf("[LiDAR] No valid data processed for channel %d\n", ch);
+			KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] No valid data processed for channel %d\n", ch);
 			return;
 		}
-
-		// Update the output buffer
-		output->len_buf[ch] = std::move(len_);
 	} catch (const std::exception& e) {
-		printf("[LiDAR] Error in parseLength: %s\n", e.what());
+		KANAVI_LOG_ERROR("[LiDAR] Error in parseLength: %s\n", e.what());
 	}
-=======
-	std::vector<float> len_;
+}
 
-	int start = KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START;
-	int end = input.size() - KANAVI::COMMON::PROTOCOL_SIZE::CHECKSUM;
+void kanavi_lidar::parseDetection(const u_char *input, size_t size)
+{
+	int pos = static_cast<int>(size) - KANAVI::COMMON::PROTOCOL_POS::CHECKSUM - KANAVI::COMMON::PROTOCOL_SIZE::DITECTION;
+	if (pos < KANAVI::COMMON::PROTOCOL_POS::RAWDATA_START) {
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] No detection byte in packet\n");
+		return;
+	}
+
+	uint8_t detection = input[pos];
+	if (detection != status_.detection || !(status_.flags & KANAVI::STATUS::DETECTION_VALID)) {
+		status_.detection = detection;
+		status_.flags |= KANAVI::STATUS::DETECTION_VALID;
+		checked_status_changed = true;
+	}
+}
 
-	float up = 0;
-	float low = 0;
-	float len = 0;
+void kanavi_lidar::parseAreaConfig(const std::vector<u_char> &input)
+{
+	size_t end = KANAVI::STATUS::AREA_CONFIG_START + KANAVI::STATUS::AREA_CONFIG_SIZE;
+	if (input.size() < end + KANAVI::COMMON::PROTOCOL_POS::CHECKSUM) {
+		KANAVI_LOG_WARN_THROTTLE(1000, "[LiDAR] Invalid area config size: %zu\n", input.size());
+		return;
+	}
 
-	for (int i = start; i < end; i += 2)
-	{
-		up = input[i];
-		low = input[i + 1];
-		len = up + low / 100; // convert 2 byte to length[m]
-		len_.push_back(len);
+	if (!std::equal(input.begin() + KANAVI::STATUS::AREA_CONFIG_START, input.begin() + end, status_.area_config) ||
+		!(status_.flags & KANAVI::STATUS::AREA_CONFIG_VALID)) {
+		std::copy(input.begin() + KANAVI::STATUS::AREA_CONFIG_START, input.begin() + end, status_.area_config);
+		status_.flags |= KANAVI::STATUS::AREA_CONFIG_VALID;
+		checked_status_changed = true;
 	}
-	output->len_buf[ch] = len_;
-	// checked_pares_end = true;
->>>>>>> a5b66cff43279b37025a24310b4ee71a65cbfcf2
 }
 
 bool kanavi_lidar::checkedProcessEnd()
@@ -522,7 +473,32 @@ bool kanavi_lidar::checkedProcessEnd()
 	return checked_pares_end;
 }
 
-kanaviDatagram kanavi_lidar::getDatagram()
+bool kanavi_lidar::checkedChannelEnd()
+{
+	return checked_channel_end;
+}
+
+int kanavi_lidar::getLastChannel()
+{
+	return last_channel;
+}
+
+const kanaviDatagram &kanavi_lidar::getDatagram()
+{
+	return *datagram_;
+}
+
+kanaviDatagram &kanavi_lidar::getMutableDatagram()
 {
 	return *datagram_;
+}
+
+bool kanavi_lidar::checkedStatusChanged()
+{
+	return checked_status_changed;
+}
+
+const kanaviStatus &kanavi_lidar::getStatus()
+{
+	return status_;
 }
\ No newline at end of file
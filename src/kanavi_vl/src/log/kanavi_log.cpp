@@ -0,0 +1,277 @@
+#include "kanavi_log.h"
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace KANAVI
+{
+	namespace LOG
+	{
+		namespace
+		{
+			/**
+			 * @brief bounded multi-producer ring with a single drain thread
+			 *
+			 * Each slot carries a sequence number, so producers only contend on
+			 * a single compare-exchange of the enqueue position.
+			 */
+			class kanavi_logger
+			{
+			private:
+				struct slot
+				{
+					std::atomic<size_t> seq;
+					record rec;
+				};
+
+				std::unique_ptr<slot[]> ring_;
+				std::atomic<size_t> enqueue_pos_;
+				size_t dequeue_pos_;
+				std::atomic<size_t> written_;
+				std::atomic<size_t> dropped_;
+				std::atomic<bool> running_;
+				std::thread worker_;
+
+				bool pop(record &out)
+				{
+					slot &s = ring_[dequeue_pos_ & (RING_SIZE - 1)];
+					if (s.seq.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+					{
+						return false;
+					}
+					out = s.rec;
+					s.seq.store(dequeue_pos_ + RING_SIZE, std::memory_order_release);
+					dequeue_pos_++;
+					return true;
+				}
+
+				void drain()
+				{
+					record rec;
+					while (true)
+					{
+						bool idle = true;
+						while (pop(rec))
+						{
+							print(rec);
+							written_.fetch_add(1, std::memory_order_release);
+							idle = false;
+						}
+
+						size_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+						if (dropped > 0)
+						{
+							fprintf(stderr, "[LOG] ring full, %zu messages dropped\n", dropped);
+						}
+
+						if (idle)
+						{
+							fflush(stdout);
+							if (!running_.load(std::memory_order_acquire))
+							{
+								break;
+							}
+							std::this_thread::sleep_for(std::chrono::milliseconds(1));
+						}
+					}
+				}
+
+				static void print(const record &rec)
+				{
+					FILE *out = (rec.level >= LEVEL_WARN) ? stderr : stdout;
+
+					char spec[32];
+					char buf[128];
+					int arg = 0;
+					const char *p = rec.fmt;
+
+					while (*p)
+					{
+						if (*p != '%')
+						{
+							const char *q = strchr(p, '%');
+							size_t len = q ? static_cast<size_t>(q - p) : strlen(p);
+							fwrite(p, 1, len, out);
+							p += len;
+							continue;
+						}
+
+						if (p[1] == '%')
+						{
+							fputc('%', out);
+							p += 2;
+							continue;
+						}
+
+						// flags, width, precision (length modifiers are dropped, see below)
+						size_t n = 0;
+						spec[n++] = *p++;
+						while (*p && strchr("-+ #0123456789.", *p) && n < sizeof(spec) - 4)
+						{
+							spec[n++] = *p++;
+						}
+						while (*p && strchr("hlLqjzt", *p))
+						{
+							p++;
+						}
+						char conv = *p;
+						if (conv == '\0')
+						{
+							break;
+						}
+						p++;
+
+						if (arg >= rec.argc)
+						{
+							fputs("(?)", out);
+							continue;
+						}
+
+						uint8_t type = rec.types[arg];
+						const auto &value = rec.args[arg];
+						arg++;
+
+						switch (conv)
+						{
+						case 'd':
+						case 'i':
+						case 'u':
+						case 'x':
+						case 'X':
+						case 'o':
+						case 'c':
+						{
+							long long v = (type == ARG_DOUBLE) ? static_cast<long long>(value.f) : value.i;
+							if (conv == 'c')
+							{
+								spec[n++] = conv;
+								spec[n] = '\0';
+								snprintf(buf, sizeof(buf), spec, static_cast<int>(v));
+							}
+							else
+							{
+								spec[n++] = 'l';
+								spec[n++] = 'l';
+								spec[n++] = conv;
+								spec[n] = '\0';
+								snprintf(buf, sizeof(buf), spec, v);
+							}
+							break;
+						}
+						case 'f':
+						case 'F':
+						case 'e':
+						case 'E':
+						case 'g':
+						case 'G':
+						{
+							double v = value.f;
+							if (type == ARG_INT)
+							{
+								v = static_cast<double>(value.i);
+							}
+							else if (type == ARG_UINT)
+							{
+								v = static_cast<double>(value.u);
+							}
+							spec[n++] = conv;
+							spec[n] = '\0';
+							snprintf(buf, sizeof(buf), spec, v);
+							break;
+						}
+						case 's':
+							spec[n++] = conv;
+							spec[n] = '\0';
+							snprintf(buf, sizeof(buf), spec, (type == ARG_TEXT) ? rec.text + value.text : "(?)");
+							break;
+						case 'p':
+							snprintf(buf, sizeof(buf), "%p", value.p);
+							break;
+						default:
+							buf[0] = '\0';
+							break;
+						}
+						fputs(buf, out);
+					}
+				}
+
+			public:
+				kanavi_logger() : ring_(new slot[RING_SIZE]), enqueue_pos_(0), dequeue_pos_(0),
+					written_(0), dropped_(0), running_(true)
+				{
+					for (size_t i = 0; i < RING_SIZE; i++)
+					{
+						ring_[i].seq.store(i, std::memory_order_relaxed);
+					}
+					worker_ = std::thread(&kanavi_logger::drain, this);
+				}
+
+				~kanavi_logger()
+				{
+					running_.store(false, std::memory_order_release);
+					if (worker_.joinable())
+					{
+						worker_.join();
+					}
+				}
+
+				void push(const record &rec)
+				{
+					size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+					slot *s;
+					while (true)
+					{
+						s = &ring_[pos & (RING_SIZE - 1)];
+						size_t seq = s->seq.load(std::memory_order_acquire);
+						intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+						if (diff == 0)
+						{
+							if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+							{
+								break;
+							}
+						}
+						else if (diff < 0)
+						{
+							// full : never block the caller
+							dropped_.fetch_add(1, std::memory_order_relaxed);
+							return;
+						}
+						else
+						{
+							pos = enqueue_pos_.load(std::memory_order_relaxed);
+						}
+					}
+					s->rec = rec;
+					s->seq.store(pos + 1, std::memory_order_release);
+				}
+
+				void flush()
+				{
+					size_t target = enqueue_pos_.load(std::memory_order_acquire);
+					while (written_.load(std::memory_order_acquire) < target && running_.load(std::memory_order_acquire))
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}
+			};
+
+			kanavi_logger &instance()
+			{
+				static kanavi_logger logger;
+				return logger;
+			}
+		} // namespace
+
+		void push(const record &rec)
+		{
+			instance().push(rec);
+		}
+
+		void flush()
+		{
+			instance().flush();
+		}
+	} // namespace LOG
+} // namespace KANAVI
@@ -1,9 +1,36 @@
 #include "ros1/kanavi_node.h"
+#include "kanavi_log.h"
+
+#include <cmath>
 
 kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_)
+	: queue_(nullptr), shared_publish_(false), running_(true)
+{
+	initialize(node_, argc_, argv_);
+}
+
+kanavi_node::kanavi_node(const ros::NodeHandle &nh, ros::CallbackQueue *queue, const std::string &node_, int &argc_, char **argv_)
+	: nh_(nh), queue_(queue), shared_publish_(true), running_(true)
+{
+	// callbacks stay on the receive thread, as in the standalone node
+	nh_.setCallbackQueue(queue_);
+	initialize(node_, argc_, argv_);
+}
+
+void kanavi_node::initialize(const std::string &node_, int &argc_, char **argv_)
 {
 	checked_multicast_ = false;
 	checked_help_ = false;
+	checked_stream_ = false;
+	checked_organized_ = false;
+	checked_scan_ = false;
+	g_calibcheck = 0;
+	checked_background_ = false;
+	g_foregroundsent = false;
+	checked_delta_ = false;
+	checked_status_ = false;
+	checked_cluster_ = false;
+	accumulateFrames_ = 0;
 
 	// check help
 	for (int i = 0; i < argc_; i++)
@@ -13,9 +40,8 @@ kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_)
 			helpAlarm();
 			checked_help_ = true;
 
-			timer_ = nh_.createTimer(ros::Duration(1), std::bind(&kanavi_node::endProcess, this));
-			// break;
-			exit(1);
+			// the caller (main, nodelet) decides how to end, a nodelet manager keeps running
+			throw std::runtime_error("help printed, node not started");
 		}
 	}
 
@@ -34,6 +60,40 @@ kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_)
 		topicName_ = argvs.topicName;
 		fixedName_ = argvs.fixedName;
 		checked_multicast_ = argvs.checked_multicast;
+		checked_stream_ = argvs.checked_stream;
+		checked_organized_ = argvs.checked_organized;
+		checked_scan_ = argvs.checked_scan;
+		colorName_ = argvs.colorName;
+		colorRange_ = argvs.colorRange;
+		layoutName_ = argvs.layout;
+		streamLayoutName_ = argvs.streamLayout.empty() ? argvs.layout : argvs.streamLayout;
+		rangeImageUnit_ = argvs.rangeImageUnit;
+		calibPath_ = argvs.calibPath;
+		pose_ = argvs.pose;
+		crop_ = argvs.crop;
+		voxelSize_ = argvs.voxelSize;
+		voxelPolicy_ = argvs.voxelPolicy;
+		temporalMode_ = argvs.temporalMode;
+		temporalFrames_ = argvs.temporalFrames;
+		temporalTolerance_ = argvs.temporalTolerance;
+		checked_background_ = argvs.checked_background;
+		backgroundTolerance_ = argvs.backgroundTolerance;
+		backgroundFrames_ = argvs.backgroundFrames;
+		backgroundMinBeams_ = argvs.backgroundMinBeams;
+		checked_delta_ = argvs.checked_delta;
+		deltaThreshold_ = argvs.deltaThreshold;
+		deltaInterval_ = argvs.deltaInterval;
+		zonePath_ = argvs.zonePath;
+		checked_status_ = argvs.checked_status;
+		checked_cluster_ = argvs.checked_cluster;
+		clusterRangeJump_ = argvs.clusterRangeJump;
+		clusterAngularGap_ = argvs.clusterAngularGap;
+		clusterMinPoints_ = argvs.clusterMinPoints;
+		accumulateFrames_ = argvs.accumulateFrames;
+		accumulateDecimation_ = argvs.accumulateDecimation;
+		odomTopic_ = argvs.odomTopic;
+		poseFrame_ = argvs.poseFrame;
+		sensorName_ = !argvs.sensorFrame.empty() ? argvs.sensorFrame : (!poseFrame_.empty() ? poseFrame_ : fixedName_);
 
 		log_set_parameters();
 
@@ -70,11 +130,63 @@ kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_)
 
 		if (model_ < 0)
 		{
-			return;
+			// the destructor does not run for a throwing constructor
+			m_udp->disconnect();
+			throw std::runtime_error("unknown model '" + node_ + "' (r2, r4, r270)");
+		}
+
+		// mounting pose : a static TF overrides -pose
+		if (!poseFrame_.empty())
+		{
+			lookupPose();
 		}
 
 		calculateAngular(model_);
 
+		// range / azimuth / channel / box crop, precomputed per beam
+		if (crop_.isActive())
+		{
+			m_crop = std::make_unique<kanavi_crop>(crop_, *m_projection);
+		}
+
+		// intrinsic calibration, applied once the sender of the first packet is known
+		if (!calibPath_.empty())
+		{
+			try
+			{
+				m_calibration = std::make_unique<kanavi_calibration>(calibPath_);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, specification is used\n", e.what());
+			}
+		}
+
+		// per-beam temporal filter over the last frames
+		if (!temporalMode_.empty())
+		{
+			try
+			{
+				m_temporal = std::make_unique<kanavi_temporal>(temporalMode_, temporalFrames_, temporalTolerance_,
+															   m_projection->getChannels(), m_projection->getBeams());
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, temporal filter disabled\n", e.what());
+			}
+		}
+
+		// range -> color table
+		try
+		{
+			m_palette = std::make_unique<kanavi_palette>(colorName_, colorRange_);
+		}
+		catch (const std::exception &e)
+		{
+			printf("[NODE] %s, fall back to %s\n", e.what(), KANAVI::PALETTE::HSV.c_str());
+			m_palette = std::make_unique<kanavi_palette>(KANAVI::PALETTE::HSV, KANAVI::PALETTE::DEFAULT_RANGE);
+		}
+
 		// init LiDAR processor
 		kanavi_ = std::make_unique<kanavi_lidar>(model_);
 
@@ -82,8 +194,209 @@ kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_)
 		// auto qos_profile = rclcpp::QoS(rclcpp::KeepLast(10));
 		publisher_ = nh_.advertise<sensor_msgs::PointCloud2>(topicName_, 1);
 
-		// init. point cloud
-		g_pointcloud.reset(new PointCloudT);
+		// only R4 decodes a frame channel by channel, R2 / R270 never finish a single channel
+		if (checked_stream_ && model_ != KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4)
+		{
+			printf("[NODE] %s is only supported by R4, channel stream disabled\n", KANAVI::ROS::PARAMETER_STREAM.c_str());
+			checked_stream_ = false;
+		}
+
+		if (checked_stream_)
+		{
+			for (int ch = 0; ch < m_projection->getChannels(); ch++)
+			{
+				channel_publishers_.push_back(nh_.advertise<sensor_msgs::PointCloud2>(topicName_ + "_ch" + std::to_string(ch), 1));
+			}
+		}
+
+		// range image : channels x beams, no projection
+		if (!rangeImageUnit_.empty())
+		{
+			try
+			{
+				m_image = std::make_unique<kanavi_image>(rangeImageUnit_, m_projection->getChannels(), m_projection->getBeams());
+
+				g_imagemsg.header.frame_id = sensorName_;
+				g_imagemsg.height = m_image->getHeight();
+				g_imagemsg.width = m_image->getWidth();
+				g_imagemsg.encoding = sensor_msgs::image_encodings::MONO16;
+				g_imagemsg.is_bigendian = 0;
+				g_imagemsg.step = m_image->getStep();
+				g_imagemsg.data.resize(static_cast<size_t>(g_imagemsg.step) * g_imagemsg.height);
+
+				image_publisher_ = nh_.advertise<sensor_msgs::Image>(topicName_ + "_range_image", 1);
+				angle_publisher_ = nh_.advertise<std_msgs::Float32MultiArray>(topicName_ + "_beam_angles", 1, true);
+				publishBeamAngles();
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, range image disabled\n", e.what());
+			}
+		}
+
+		// LaserScan : R270 as is, R2/R4 one scan per ring
+		if (checked_scan_)
+		{
+			updateScanAngles();
+
+			g_scanmsg.header.frame_id = sensorName_;
+			g_scanmsg.time_increment = 0;
+			g_scanmsg.range_min = KANAVI::SCAN::RANGE_MIN;
+			g_scanmsg.range_max = KANAVI::SCAN::RANGE_MAX;
+			g_scanmsg.ranges.resize(m_scan->getBeams());
+
+			for (int ch = 0; ch < m_projection->getChannels(); ch++)
+			{
+				std::string suffix = (m_projection->getChannels() == 1) ? "_scan" : "_scan_ch" + std::to_string(ch);
+				scan_publishers_.push_back(nh_.advertise<sensor_msgs::LaserScan>(topicName_ + suffix, 1));
+			}
+		}
+
+		// init. PointCloud2 layout & reused messages
+		m_cloud = createLayout(layoutName_);
+		m_channelcloud = createLayout(streamLayoutName_);
+		initCloudMsg(g_cloudmsg, *m_cloud, static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams());
+		initCloudMsg(g_channelmsg, *m_channelcloud, m_projection->getBeams());
+
+		// voxel grid downsampling on its own topic
+		if (voxelSize_ > 0)
+		{
+			try
+			{
+				size_t capacity = static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams();
+				m_voxel = std::make_unique<kanavi_voxel>(voxelSize_, voxelPolicy_, capacity);
+
+				// a voxel has no single ring / beam
+				const std::string &layout = (m_cloud->getLayout() == KANAVI::CLOUD::XYZRBR) ? KANAVI::CLOUD::LAYOUT_XYZ : m_cloud->getName();
+				m_voxelcloud = std::make_unique<kanavi_cloud>(layout, false);
+				initCloudMsg(g_voxelmsg, *m_voxelcloud, capacity);
+
+				voxel_publisher_ = nh_.advertise<sensor_msgs::PointCloud2>(topicName_ + "_voxel", 1);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, voxel grid disabled\n", e.what());
+			}
+		}
+
+		// learned static background, only the beams in front of it are published
+		if (checked_background_)
+		{
+			try
+			{
+				m_background = std::make_unique<kanavi_background>(backgroundTolerance_, backgroundFrames_, backgroundMinBeams_,
+																   m_projection->getChannels(), m_projection->getBeams());
+
+				// xyzrbr keeps the beam index & range of every foreground point
+				m_foregroundcloud = std::make_unique<kanavi_cloud>(m_cloud->getName(), false);
+				initCloudMsg(g_foregroundmsg, *m_foregroundcloud, static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams());
+
+				foreground_publisher_ = nh_.advertise<sensor_msgs::PointCloud2>(topicName_ + "_foreground", 1);
+				activity_publisher_ = nh_.advertise<std_msgs::Bool>(topicName_ + "_activity", 1);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, background model disabled\n", e.what());
+			}
+		}
+
+		// compact keyframe + delta frames for thin links
+		if (checked_delta_)
+		{
+			try
+			{
+				m_delta = std::make_unique<kanavi_delta_encoder>(m_projection->getChannels(), m_projection->getBeams(),
+																 deltaThreshold_, deltaInterval_);
+				delta_publisher_ = nh_.advertise<std_msgs::UInt8MultiArray>(topicName_ + "_delta", 1);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, delta frames disabled\n", e.what());
+			}
+		}
+
+		// polygon intrusion zones, compiled into per-beam range intervals
+		if (!zonePath_.empty())
+		{
+			try
+			{
+				m_zone = std::make_unique<kanavi_zone>(zonePath_);
+				m_zone->compile(*m_projection);
+
+				for (size_t i = 0; i < m_zone->size(); i++)
+				{
+					zone_publishers_.push_back(nh_.advertise<std_msgs::Bool>(topicName_ + "_zone_" + m_zone->getName(i), 1, true));
+				}
+				publishZones(true);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, zones disabled\n", e.what());
+			}
+		}
+
+		// detection bits & area configuration, decoded in the parse pass
+		if (checked_status_)
+		{
+			status_publisher_ = nh_.advertise<std_msgs::UInt8MultiArray>(topicName_ + "_status", 1, true);
+			g_statusmsg.data.resize(2 + KANAVI::STATUS::AREA_CONFIG_SIZE);
+		}
+
+		// objects segmented in one pass along scan order
+		if (checked_cluster_)
+		{
+			try
+			{
+				m_cluster = std::make_unique<kanavi_cluster>(clusterRangeJump_, clusterAngularGap_, clusterMinPoints_,
+															 m_projection->getChannels(), m_projection->getBeams(), m_projection->getHorizontalResolution());
+
+				g_clustermsg.layout.dim.resize(2);
+				g_clustermsg.layout.dim[0].label = "clusters";
+				g_clustermsg.layout.dim[1].label = "fields";	// centroid xyz, min xyz, max xyz, count
+				g_clustermsg.layout.dim[1].size = KANAVI::CLUSTER::FIELDS;
+				g_clustermsg.layout.dim[1].stride = KANAVI::CLUSTER::FIELDS;
+				g_clustermsg.data.reserve(static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams() * KANAVI::CLUSTER::FIELDS);
+
+				cluster_publisher_ = nh_.advertise<std_msgs::Float32MultiArray>(topicName_ + "_clusters", 1);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, clustering disabled\n", e.what());
+			}
+		}
+
+		// sliding window of the last frames for sparse sensors
+		if (accumulateFrames_ > 0)
+		{
+			try
+			{
+				size_t capacity = static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams();
+				m_accumulate = std::make_unique<kanavi_accumulate>(accumulateFrames_, accumulateDecimation_, capacity);
+
+				// organized, a row per frame keeps every frame at a fixed place in the buffer
+				m_acccloud = std::make_unique<kanavi_cloud>(m_cloud->getName(), true);
+				initCloudMsg(g_accmsg, *m_acccloud, capacity * accumulateFrames_);
+				finishCloudMsg(g_accmsg, capacity, accumulateFrames_);
+
+				// every row starts without points
+				size_t beams = static_cast<size_t>(m_projection->getBeams());
+				for (size_t row = 0; row < static_cast<size_t>(accumulateFrames_) * m_projection->getChannels(); row++)
+				{
+					m_acccloud->writeInvalid(&g_accmsg.data[row * beams * m_acccloud->getPointStep()],
+											 static_cast<int>(row % m_projection->getChannels()), 0, static_cast<int>(beams));
+				}
+
+				accumulate_publisher_ = nh_.advertise<sensor_msgs::PointCloud2>(topicName_ + "_accumulated", 1);
+				if (!odomTopic_.empty())
+				{
+					odom_subscriber_ = nh_.subscribe(odomTopic_, 10, &kanavi_node::odometryCallback, this);
+				}
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, accumulation disabled\n", e.what());
+			}
+		}
 	}
 }
 
@@ -100,8 +413,39 @@ void kanavi_node::helpAlarm()
 		   "%s : set multicast & IP\n"
 		   "\t ex) %s [ip]\n"
 		   "%s : set fixed frame Name for rviz\n"
-		   "%s : set topic name for rviz\n",
-		   KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_FIXED.c_str(), KANAVI::ROS::PARAMETER_TOPIC.c_str());
+		   "%s : set topic name for rviz\n"
+		   "%s : publish each channel as soon as it is decoded (R4)\n"
+		   "%s : set point color palette (hsv, gray, none)\n"
+		   "%s : set distance of one palette span [m]\n"
+		   "%s : set point layout (xyz, xyzrgb, xyzrbr, xyz16)\n"
+		   "%s : set point layout of the channel stream\n"
+		   "%s : organized cloud (height = channels, width = beams, NaN = no return)\n"
+		   "%s : publish 16-bit range image (cm, mm)\n"
+		   "%s : publish LaserScan (R270 : one scan, R2/R4 : one scan per ring)\n"
+		   "%s : set intrinsic calibration file (reloaded on change)\n"
+		   "%s : set mounting pose in the fixed frame [m, deg]\n"
+		   "\t ex) %s [x] [y] [z] [roll] [pitch] [yaw]\n"
+		   "%s : look up the mounting pose from a static TF (sensor frame)\n"
+		   "%s : set frame ID of the range image & LaserScan (default : -pose_tf frame, else -fix)\n"
+		   "%s : keep measured ranges within [min] [max] [m]\n"
+		   "%s : keep azimuths within [min] [max] [deg]\n"
+		   "%s : keep listed channels only (ex. 0,1,3)\n"
+		   "%s : keep points inside a box [xmin] [ymin] [zmin] [xmax] [ymax] [zmax] [m]\n"
+		   "%s : publish voxel grid downsampled cloud [leaf m] [centroid|first]\n"
+		   "%s : filter ranges over the last frames [median|persistence] [frames] [tolerance m]\n"
+		   "%s : publish beams in front of the learned background [tolerance m] [frames] [min beams]\n"
+		   "%s : publish keyframe + delta encoded frames [threshold m] [keyframe interval]\n"
+		   "%s : set intrusion zone file (polygons, state published on change)\n"
+		   "%s : publish sensor detection bits & area configuration (on change)\n"
+		   "%s : publish scan-order clusters [range jump m] [angular gap deg] [min points]\n"
+		   "%s : publish the last frames together [frames] [publish every N frames] [odometry topic]\n",
+		   KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_FIXED.c_str(), KANAVI::ROS::PARAMETER_TOPIC.c_str(),
+		   KANAVI::ROS::PARAMETER_STREAM.c_str(), KANAVI::ROS::PARAMETER_COLOR.c_str(), KANAVI::ROS::PARAMETER_COLOR_RANGE.c_str(),
+		   KANAVI::ROS::PARAMETER_LAYOUT.c_str(), KANAVI::ROS::PARAMETER_STREAM_LAYOUT.c_str(), KANAVI::ROS::PARAMETER_ORGANIZED.c_str(), KANAVI::ROS::PARAMETER_RANGE_IMAGE.c_str(), KANAVI::ROS::PARAMETER_SCAN.c_str(),
+		   KANAVI::ROS::PARAMETER_CALIBRATION.c_str(), KANAVI::ROS::PARAMETER_POSE.c_str(), KANAVI::ROS::PARAMETER_POSE.c_str(), KANAVI::ROS::PARAMETER_POSE_TF.c_str(), KANAVI::ROS::PARAMETER_SENSOR_FRAME.c_str(),
+		   KANAVI::ROS::PARAMETER_RANGE.c_str(), KANAVI::ROS::PARAMETER_AZIMUTH.c_str(), KANAVI::ROS::PARAMETER_CHANNELS.c_str(), KANAVI::ROS::PARAMETER_CROP_BOX.c_str(),
+		   KANAVI::ROS::PARAMETER_VOXEL.c_str(), KANAVI::ROS::PARAMETER_TEMPORAL.c_str(), KANAVI::ROS::PARAMETER_BACKGROUND.c_str(), KANAVI::ROS::PARAMETER_DELTA.c_str(), KANAVI::ROS::PARAMETER_ZONES.c_str(),
+		   KANAVI::ROS::PARAMETER_STATUS.c_str(), KANAVI::ROS::PARAMETER_CLUSTER.c_str(), KANAVI::ROS::PARAMETER_ACCUMULATE.c_str());
 }
 
 std::vector<u_char> kanavi_node::receiveDatagram()
@@ -129,6 +473,79 @@ void kanavi_node::log_set_parameters()
 	}
 	printf("Fixed Frame Name :\t%s\n", fixedName_.c_str());
 	printf("Topic Name :\t%s\n", topicName_.c_str());
+	if (checked_stream_)
+	{
+		printf("Channel Stream :\t%s_ch*\n", topicName_.c_str());
+	}
+	printf("Color Palette :\t%s (%.1f m)\n", colorName_.c_str(), colorRange_);
+	printf("Point Layout :\t%s%s\n", layoutName_.c_str(), checked_organized_ ? " (organized)" : "");
+	if (!rangeImageUnit_.empty())
+	{
+		printf("Range Image :\t%s_range_image [%s]\n", topicName_.c_str(), rangeImageUnit_.c_str());
+	}
+	if (checked_scan_)
+	{
+		printf("Laser Scan :\t%s_scan*\n", topicName_.c_str());
+	}
+	if (checked_stream_)
+	{
+		printf("Stream Layout :\t%s\n", streamLayoutName_.c_str());
+	}
+	if (!calibPath_.empty())
+	{
+		printf("Calibration :\t%s\n", calibPath_.c_str());
+	}
+	if (!poseFrame_.empty())
+	{
+		printf("Mounting Pose :\tTF %s -> %s\n", poseFrame_.c_str(), fixedName_.c_str());
+	}
+	else
+	{
+		printf("Mounting Pose :\t%.3f %.3f %.3f [m] %.2f %.2f %.2f [deg]\n", pose_.x, pose_.y, pose_.z, pose_.roll, pose_.pitch, pose_.yaw);
+	}
+	if (!rangeImageUnit_.empty() || checked_scan_)
+	{
+		printf("Sensor Frame Name :\t%s\n", sensorName_.c_str());
+	}
+	if (crop_.isActive())
+	{
+		printf("Crop :\trange %.2f ~ %.2f [m], azimuth %.1f ~ %.1f [deg], %s channels%s\n", crop_.range_min, crop_.range_max,
+			   crop_.azimuth_min, crop_.azimuth_max, crop_.channels.empty() ? "all" : "selected", crop_.box ? ", box" : "");
+	}
+	if (voxelSize_ > 0)
+	{
+		printf("Voxel Grid :\t%s_voxel [%.3f m, %s]\n", topicName_.c_str(), voxelSize_, voxelPolicy_.c_str());
+	}
+	if (!temporalMode_.empty())
+	{
+		printf("Temporal Filter :\t%s [%d frames, %.2f m]\n", temporalMode_.c_str(), temporalFrames_, temporalTolerance_);
+	}
+	if (checked_background_)
+	{
+		printf("Background :\t%s_foreground, %s_activity [%.2f m, %d frames, %d beams]\n", topicName_.c_str(), topicName_.c_str(),
+			   backgroundTolerance_, backgroundFrames_, backgroundMinBeams_);
+	}
+	if (checked_delta_)
+	{
+		printf("Delta Frames :\t%s_delta [%.3f m, keyframe every %d]\n", topicName_.c_str(), deltaThreshold_, deltaInterval_);
+	}
+	if (!zonePath_.empty())
+	{
+		printf("Zones :\t%s -> %s_zone_*\n", zonePath_.c_str(), topicName_.c_str());
+	}
+	if (checked_status_)
+	{
+		printf("Status :\t%s_status\n", topicName_.c_str());
+	}
+	if (checked_cluster_)
+	{
+		printf("Clusters :\t%s_clusters [%.2f m, %.2f deg, %d points]\n", topicName_.c_str(), clusterRangeJump_, clusterAngularGap_, clusterMinPoints_);
+	}
+	if (accumulateFrames_ > 0)
+	{
+		printf("Accumulation :\t%s_accumulated [%d frames, every %d, odometry %s]\n", topicName_.c_str(), accumulateFrames_, accumulateDecimation_,
+			   odomTopic_.empty() ? "none" : odomTopic_.c_str());
+	}
 	printf("--------------------------------\n");
 }
 
@@ -145,207 +562,675 @@ void kanavi_node::run()
 	//! SECTION
 
 	// SECTION - RUN ROS Node
-	while (ros::ok())
+	while (ros::ok() && running_)
 	{
 		// recv data from UDP
 		std::vector<u_char> buf_ = receiveDatagram();
 
+		// the frame-end flag stays set until the next CH0, only the packet completing the frame hands it over
+		bool checked_frame_end = false;
+
 		if(!buf_.empty())
 		{
-			kanavi_->process(buf_);
+			ros::Time recv_stamp = ros::Time::now();
+
+			updateCalibration();
+
+			checked_frame_end = kanavi_->process(buf_) == KANAVI::PROCESS::InputMode::SUCCESS && kanavi_->checkedProcessEnd();
+
+			// sensor outputs at packet rate, no cloud needed
+			if (checked_status_ && kanavi_->checkedStatusChanged())
+			{
+				publishStatus();
+			}
+
+			// stream the decoded channel without waiting for the whole frame
+			if (checked_stream_ && kanavi_->checkedChannelEnd())
+			{
+				publishChannel(kanavi_->getLastChannel(), recv_stamp);
+			}
 		}
 
 		// get Point Cloud from Lidar processor
-		if (kanavi_->checkedProcessEnd())
+		if (checked_frame_end)
 		{
-			// datagram Length -> pointcloud
-			length2PointCloud(kanavi_->getDatagram());
-
-			// rotate Center
-			rotateAxisZ(g_pointcloud, rotate_angle);
+			ros::Time stamp = ros::Time::now();
 
 			// streaming..
-			printf("[NODE] PULISHING\n");
-			publisher_.publish(cloud_to_cloud_msg(g_pointcloud->width,
-												  g_pointcloud->height,
-												  *g_pointcloud,
-												  100,
-												  fixedName_));
+			KANAVI_LOG_INFO_THROTTLE(1000, "[NODE] PUBLISHING\n");
+
+			// every frame goes through the ring, the outputs below see filtered ranges
+			if (m_temporal)
+			{
+				m_temporal->filter(kanavi_->getMutableDatagram().len_buf);
+			}
+
+			// zones first, one pass of range compares before any projection
+			if (m_zone && m_zone->evaluate(kanavi_->getDatagram().len_buf))
+			{
+				publishZones(false);
+			}
+
+			// projection only runs when someone listens to the cloud
+			if (publisher_.getNumSubscribers() > 0 || (!m_image && !m_scan && !m_voxel && !m_cluster))
+			{
+				// datagram Length -> pointcloud
+				length2PointCloud(kanavi_->getDatagram());
+
+				g_cloudmsg.header.stamp = stamp;
+				publishCloud(publisher_, g_cloudmsg);
+			}
+
+			if (m_image)
+			{
+				publishRangeImage(stamp);
+			}
 
-			g_pointcloud->clear();
+			if (m_scan)
+			{
+				publishScan(stamp);
+			}
+
+			// downsampling only runs when someone listens
+			if (m_voxel && voxel_publisher_.getNumSubscribers() > 0)
+			{
+				publishVoxel(stamp);
+			}
+
+			if (m_cluster && cluster_publisher_.getNumSubscribers() > 0)
+			{
+				publishClusters();
+			}
+
+			if (m_accumulate)
+			{
+				publishAccumulated(stamp);
+			}
+
+			// learned every frame, listeners or not
+			if (m_background)
+			{
+				publishForeground(stamp);
+			}
+
+			if (m_delta)
+			{
+				publishDelta();
+			}
+		}
+
+		// odometry for the accumulation window
+		if (odom_subscriber_)
+		{
+			if (queue_)
+			{
+				queue_->callAvailable();
+			}
+			else
+			{
+				ros::spinOnce();
+			}
 		}
 	}
 	//! SECTION
 }
 
-void kanavi_node::length2PointCloud(kanaviDatagram datagram)
+void kanavi_node::length2PointCloud(const kanaviDatagram &datagram)
 {
 	// generate Point Cloud
-	generatePointCloud(datagram, *g_pointcloud);
+	generatePointCloud(datagram, g_cloudmsg);
 }
 
 void kanavi_node::calculateAngular(int model)
 {
-	switch (model)
+	// unit direction per (channel, beam) with BASE_ZERO_ANGLE folded in
+	m_projection = std::make_unique<kanavi_projection>(model, rotate_angle, KANAVI::CALIBRATION::intrinsic(), pose_);
+
+	g_proj_x.resize(m_projection->getBeams());
+	g_proj_y.resize(m_projection->getBeams());
+	g_proj_z.resize(m_projection->getBeams());
+	g_valid.resize(m_projection->getBeams());
+
+	KANAVI_LOG_INFO("[NODE] projection kernel : %s\n", m_projection->getKernelName());
+}
+
+void kanavi_node::generatePointCloud(const kanaviDatagram &datagram, sensor_msgs::PointCloud2 &msg)
+{
+	size_t points = 0;
+
+	switch (datagram.model)
 	{
 	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL; i++)
-		{
-			v_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_RESOLUTION * i)));
-			v_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_RESOLUTION * i)));
-		}
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_DATA_CNT; i++)
-		{
-			h_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION * i)));
-			h_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION * i)));
-		}
-		break;
 	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL; i++)
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
+		if (m_cloud->isOrganized())
 		{
-			v_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION * i)));
-			v_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION * i)));
+			// one full row per channel, missing channels are NaN rows
+			size_t beams = static_cast<size_t>(m_projection->getBeams());
+			for (int ch = 0; ch < m_projection->getChannels(); ch++)
+			{
+				generateChannelPointCloud(datagram, ch, *m_cloud, msg, ch * beams);
+			}
+			finishCloudMsg(msg, beams, m_projection->getChannels());
+			return;
 		}
 
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_DATA_CNT; i++)
+		for (int ch = 0; ch < static_cast<int>(datagram.len_buf.size()); ch++)
 		{
-			h_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION * i)));
-			h_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION * i)));
+			points += generateChannelPointCloud(datagram, ch, *m_cloud, msg, points);
 		}
 		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_DATA_CNT; i++)
-		{
-			h_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION * i)));
-			h_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION * i)));
-		}
+	default:
+		KANAVI_LOG_ERROR_THROTTLE(1000, "[NODE] Unknown model type: %d\n", datagram.model);
 		break;
 	}
+
+	finishCloudMsg(msg, points);
 }
 
-void kanavi_node::generatePointCloud(const kanaviDatagram &datagram, PointCloudT &cloud_)
+size_t kanavi_node::projectChannel(const kanaviDatagram &datagram, int ch)
 {
-	switch (datagram.model)
+	if (ch < 0 || ch >= m_projection->getChannels() || ch >= static_cast<int>(datagram.len_buf.size()))
 	{
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-		for (int ch = 0; ch < KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL; ch++)
+		return 0;
+	}
+	if (m_crop && !m_crop->isChannelEnabled(ch))
+	{
+		return 0;
+	}
+
+	const std::vector<float> &len_ = datagram.len_buf[ch];
+	size_t cnt = std::min(len_.size(), static_cast<size_t>(m_projection->getBeams()));
+	if (cnt == 0)
+	{
+		return 0;
+	}
+
+	// no return (0 m) and cropped beams are dropped, NaN when the beam has to keep its slot
+	if (m_crop)
+	{
+		m_crop->mask(len_.data(), ch, static_cast<int>(cnt), g_valid.data());
+	}
+	else
+	{
+		for (size_t i = 0; i < cnt; i++)
 		{
-			for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_DATA_CNT; i++)
-			{
-				cloud_.push_back(length2point(datagram.len_buf[ch][i], v_sin[ch], v_cos[ch], h_sin[i], h_cos[i]));
-			}
+			g_valid[i] = (len_[i] > 0) ? 1 : 0;
 		}
-		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-		for (int ch = 0; ch < KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL; ch++)
+	}
+
+	// whole row at once through the SIMD kernel
+	m_projection->project(len_.data(), ch, static_cast<int>(cnt), g_proj_x.data(), g_proj_y.data(), g_proj_z.data());
+
+	return cnt;
+}
+
+size_t kanavi_node::generateChannelPointCloud(const kanaviDatagram &datagram, int ch, const kanavi_cloud &layout, sensor_msgs::PointCloud2 &msg, size_t offset)
+{
+	if (ch < 0 || ch >= m_projection->getChannels())
+	{
+		return 0;
+	}
+
+	size_t beams = static_cast<size_t>(m_projection->getBeams());
+	size_t cnt = projectChannel(datagram, ch);
+
+	// organized rows always span every beam
+	size_t row = layout.isOrganized() ? beams : cnt;
+	if (row == 0)
+	{
+		return 0;
+	}
+
+	// only grows on the first frame, the buffer is reused afterwards
+	size_t step = layout.getPointStep();
+	if (msg.data.size() < (offset + row) * step)
+	{
+		msg.data.resize((offset + row) * step);
+	}
+
+	size_t written = 0;
+	if (cnt > 0)
+	{
+		written = layout.write(&msg.data[offset * step], g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(),
+							   g_valid.data(), ch, static_cast<int>(cnt), *m_palette);
+	}
+
+	// organized rows keep every slot
+	if (layout.isOrganized() && written < row)
+	{
+		layout.writeInvalid(&msg.data[(offset + written) * step], ch, static_cast<int>(written), static_cast<int>(row - written));
+		written = row;
+	}
+
+	return written;
+}
+
+std::unique_ptr<kanavi_cloud> kanavi_node::createLayout(const std::string &layout)
+{
+	try
+	{
+		return std::make_unique<kanavi_cloud>(layout, checked_organized_);
+	}
+	catch (const std::exception &e)
+	{
+		printf("[NODE] %s, fall back to %s\n", e.what(), KANAVI::CLOUD::LAYOUT_XYZRGB.c_str());
+		return std::make_unique<kanavi_cloud>(KANAVI::CLOUD::LAYOUT_XYZRGB, checked_organized_);
+	}
+}
+
+void kanavi_node::initCloudMsg(sensor_msgs::PointCloud2 &msg, const kanavi_cloud &layout, size_t points)
+{
+	msg.fields.clear();
+	for (const KANAVI::CLOUD::field &f : layout.getFields())
+	{
+		sensor_msgs::PointField field;
+		field.name = f.name;
+		field.offset = f.offset;
+		field.datatype = f.datatype;
+		field.count = f.count;
+		msg.fields.push_back(field);
+	}
+
+	msg.header.frame_id = fixedName_;
+	msg.is_bigendian = false;
+	msg.is_dense = !layout.isOrganized();	// organized clouds carry NaN points
+	msg.point_step = layout.getPointStep();
+	msg.data.reserve(points * msg.point_step);
+}
+
+void kanavi_node::finishCloudMsg(sensor_msgs::PointCloud2 &msg, size_t width, size_t height)
+{
+	msg.height = static_cast<uint32_t>(height);
+	msg.width = static_cast<uint32_t>(width);
+	msg.row_step = msg.width * msg.point_step;
+	msg.data.resize(static_cast<size_t>(msg.row_step) * msg.height);	// no reallocation, capacity is kept
+}
+
+void kanavi_node::publishChannel(int ch, const ros::Time &stamp)
+{
+	if (ch < 0 || ch >= static_cast<int>(channel_publishers_.size()))
+	{
+		return;
+	}
+
+	size_t points = generateChannelPointCloud(kanavi_->getDatagram(), ch, *m_channelcloud, g_channelmsg, 0);
+	finishCloudMsg(g_channelmsg, points);
+
+	g_channelmsg.header.stamp = stamp;	// arrival time of this channel, not of the frame
+	publishCloud(channel_publishers_[ch], g_channelmsg);
+}
+
+void kanavi_node::publishCloud(ros::Publisher &publisher, sensor_msgs::PointCloud2 &msg)
+{
+	if (!shared_publish_)
+	{
+		publisher.publish(msg);
+		return;
+	}
+
+	// nodelets of the same manager get the pointer, the next frame starts on a fresh buffer of the same capacity
+	size_t capacity = msg.data.capacity();
+	sensor_msgs::PointCloud2::Ptr shared = boost::make_shared<sensor_msgs::PointCloud2>(std::move(msg));
+
+	msg.header = shared->header;
+	msg.fields = shared->fields;
+	msg.height = shared->height;
+	msg.width = shared->width;
+	msg.point_step = shared->point_step;
+	msg.row_step = shared->row_step;
+	msg.is_dense = shared->is_dense;
+	msg.is_bigendian = shared->is_bigendian;
+	msg.data.clear();
+	msg.data.reserve(capacity);
+
+	publisher.publish(sensor_msgs::PointCloud2::ConstPtr(shared));
+}
+
+void kanavi_node::publishRangeImage(const ros::Time &stamp)
+{
+	m_image->write(g_imagemsg.data.data(), kanavi_->getDatagram().len_buf);
+
+	g_imagemsg.header.stamp = stamp;
+	image_publisher_.publish(g_imagemsg);
+}
+
+void kanavi_node::publishBeamAngles()
+{
+	// data = elevation[channels] followed by azimuth[beams], [deg]
+	std_msgs::Float32MultiArray msg;
+	msg.layout.dim.resize(2);
+	msg.layout.dim[0].label = "elevation";
+	msg.layout.dim[0].size = m_projection->getChannels();
+	msg.layout.dim[0].stride = m_projection->getChannels();
+	msg.layout.dim[1].label = "azimuth";
+	msg.layout.dim[1].size = m_projection->getBeams();
+	msg.layout.dim[1].stride = m_projection->getBeams();
+	msg.layout.data_offset = 0;
+
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
+	{
+		msg.data.push_back(m_projection->getElevation(ch));
+	}
+	for (int i = 0; i < m_projection->getBeams(); i++)
+	{
+		msg.data.push_back(m_projection->getAzimuth(i));
+	}
+
+	angle_publisher_.publish(msg);
+}
+
+void kanavi_node::publishScan(const ros::Time &stamp)
+{
+	const kanaviDatagram &datagram = kanavi_->getDatagram();
+
+	// measured frame period
+	g_scanmsg.scan_time = g_laststamp.isZero() ? 0 : static_cast<float>((stamp - g_laststamp).toSec());
+	g_laststamp = stamp;
+	g_scanmsg.header.stamp = stamp;
+
+	for (size_t ch = 0; ch < scan_publishers_.size(); ch++)
+	{
+		if (ch < datagram.len_buf.size())
 		{
-			for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_DATA_CNT; i++)
-			{
-				cloud_.push_back(length2point(datagram.len_buf[ch][i], v_sin[ch], v_cos[ch], h_sin[i], h_cos[i]));
-			}
+			m_scan->write(g_scanmsg.ranges.data(), datagram.len_buf[ch].data(), static_cast<int>(datagram.len_buf[ch].size()));
 		}
-		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_DATA_CNT; i++)
+		else
 		{
-			cloud_.push_back(length2point(datagram.len_buf[0][i], 0, 1, h_sin[i], h_cos[i]));
+			m_scan->write(g_scanmsg.ranges.data(), nullptr, 0);
 		}
-		break;
-	default:
-		printf("[NODE] Unknown model type: %d\n", datagram.model);
+		scan_publishers_[ch].publish(g_scanmsg);
+	}
+}
+
+void kanavi_node::updateCalibration()
+{
+	if (!m_calibration)
+	{
+		return;
+	}
+
+	int64_t now = KANAVI::LOG::nowMs();
+	if (now - g_calibcheck < KANAVI::CALIBRATION::RELOAD_PERIOD_MS)
+	{
 		return;
 	}
+	g_calibcheck = now;
+
+	// a broken file keeps the loaded sections
+	bool reloaded = m_calibration->isModified() && m_calibration->load();
+
+	const std::string &ip = m_udp->getSenderIP();
+	if (!reloaded && ip == calibIP_)
+	{
+		return;
+	}
+	calibIP_ = ip;
+
+	KANAVI::CALIBRATION::intrinsic calib;
+	if (!m_calibration->find(ip, calib))
+	{
+		KANAVI_LOG_WARN("[NODE] no calibration of %s, specification is used\n", ip);
+	}
+
+	try
+	{
+		m_projection = std::make_unique<kanavi_projection>(m_projection->getModel(), m_projection->getBaseAngle(), calib, m_projection->getPose());
+	}
+	catch (const std::exception &e)
+	{
+		KANAVI_LOG_WARN("[NODE] %s, calibration not applied\n", e.what());
+		return;
+	}
+	if (m_crop)
+	{
+		m_crop = std::make_unique<kanavi_crop>(crop_, *m_projection);
+	}
+	if (m_zone)
+	{
+		m_zone->compile(*m_projection);
+	}
+	KANAVI_LOG_INFO("[NODE] calibration of %s applied\n", ip);
+
+	// range image consumers follow the calibrated angles
+	if (m_image)
+	{
+		publishBeamAngles();
+	}
+	if (m_scan)
+	{
+		updateScanAngles();
+	}
 }
 
-PointT kanavi_node::length2point(float len, float v_sin, float v_cos, float h_sin, float h_cos)
+void kanavi_node::updateScanAngles()
 {
-	pcl::PointXYZRGB p_;
+	m_scan = std::make_unique<kanavi_scan>(*m_projection);
 
-	p_.x = len * v_cos * h_cos;
-	p_.y = len * v_cos * h_sin;
-	p_.z = len * v_sin;
+	g_scanmsg.angle_min = m_scan->getAngleMin();
+	g_scanmsg.angle_max = m_scan->getAngleMax();
+	g_scanmsg.angle_increment = m_scan->getAngleIncrement();
 
-	float r, g, b;
-	HSV2RGB(&r, &g, &b, len * 20, 1.0, 1.0); // convert hsv to rgb
-	p_.r = r * 255;
-	p_.g = g * 255;
-	p_.b = b * 255;
+	if (m_scan->getMaxDeviation() > KANAVI::SCAN::MAX_DEVIATION)
+	{
+		KANAVI_LOG_WARN("[NODE] per-beam azimuth offsets up to %.3f deg are not shown in the uniform LaserScan angles\n",
+						m_scan->getMaxDeviation());
+	}
+}
 
-	return p_;
+void kanavi_node::lookupPose()
+{
+	// static mounting : looked up once, the listener is dropped afterwards
+	tf2_ros::Buffer buffer;
+	tf2_ros::TransformListener listener(buffer);
+
+	try
+	{
+		geometry_msgs::TransformStamped tf = buffer.lookupTransform(fixedName_, poseFrame_, ros::Time(0),
+																	ros::Duration(KANAVI::CALIBRATION::TF_TIMEOUT));
+
+		tf2::Quaternion q(tf.transform.rotation.x, tf.transform.rotation.y, tf.transform.rotation.z, tf.transform.rotation.w);
+		double roll, pitch, yaw;
+		tf2::Matrix3x3(q).getRPY(roll, pitch, yaw);
+
+		pose_.x = static_cast<float>(tf.transform.translation.x);
+		pose_.y = static_cast<float>(tf.transform.translation.y);
+		pose_.z = static_cast<float>(tf.transform.translation.z);
+		pose_.roll = static_cast<float>(roll * 180.0 / M_PI);
+		pose_.pitch = static_cast<float>(pitch * 180.0 / M_PI);
+		pose_.yaw = static_cast<float>(yaw * 180.0 / M_PI);
+	}
+	catch (const tf2::TransformException &e)
+	{
+		printf("[NODE] %s, %s is used\n", e.what(), KANAVI::ROS::PARAMETER_POSE.c_str());
+	}
 }
 
-void kanavi_node::HSV2RGB(float *fR, float *fG, float *fB, float fH, float fS, float fV)
+void kanavi_node::publishVoxel(const ros::Time &stamp)
 {
-	float fC = fV * fS;
-	float fHPrime = fmod(fH / 60.0, 6);
-	float fX = fC * (1 - fabs(fmod(fHPrime, 2) - 1));
-	float fM = fV - fC;
+	const kanaviDatagram &datagram = kanavi_->getDatagram();
 
-	if (0 <= fHPrime && fHPrime < 1)
+	m_voxel->clear();
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
 	{
-		*fR = fC;
-		*fG = fX;
-		*fB = 0;
+		size_t cnt = projectChannel(datagram, ch);
+		if (cnt > 0)
+		{
+			m_voxel->insert(g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(), g_valid.data(),
+							static_cast<int>(cnt));
+		}
 	}
-	else if (0 <= fHPrime && fHPrime < 2)
+	m_voxel->finish();
+
+	// capacity was reserved for a full frame
+	size_t points = m_voxel->size();
+	g_voxelmsg.data.resize(points * m_voxelcloud->getPointStep());
+
+	size_t written = m_voxelcloud->write(g_voxelmsg.data.data(), m_voxel->getX(), m_voxel->getY(), m_voxel->getZ(),
+										 m_voxel->getRange(), nullptr, 0, static_cast<int>(points), *m_palette);
+	finishCloudMsg(g_voxelmsg, written);
+
+	g_voxelmsg.header.stamp = stamp;
+	publishCloud(voxel_publisher_, g_voxelmsg);
+}
+
+void kanavi_node::publishForeground(const ros::Time &stamp)
+{
+	const kanaviDatagram &datagram = kanavi_->getDatagram();
+
+	m_background->update(datagram.len_buf);
+	bool active = m_background->isActive();
+
+	g_activitymsg.data = active;
+	activity_publisher_.publish(g_activitymsg);
+
+	// an empty scene costs the flag only, one empty cloud clears the last foreground
+	if (!active && !g_foregroundsent)
 	{
-		*fR = fX;
-		*fG = fC;
-		*fB = 0;
+		return;
 	}
-	else if (0 <= fHPrime && fHPrime < 3)
+
+	size_t points = 0;
+	if (active && foreground_publisher_.getNumSubscribers() > 0)
 	{
-		*fR = 0;
-		*fG = fC;
-		*fB = fX;
+		size_t step = m_foregroundcloud->getPointStep();
+		g_foregroundmsg.data.resize(static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams() * step);
+
+		for (int ch = 0; ch < m_projection->getChannels(); ch++)
+		{
+			size_t cnt = projectChannel(datagram, ch);
+			if (cnt == 0 || m_background->mask(ch, static_cast<int>(cnt), g_valid.data()) == 0)
+			{
+				continue;
+			}
+			points += m_foregroundcloud->write(&g_foregroundmsg.data[points * step], g_proj_x.data(), g_proj_y.data(), g_proj_z.data(),
+											   datagram.len_buf[ch].data(), g_valid.data(), ch, static_cast<int>(cnt), *m_palette);
+		}
 	}
-	else if (0 <= fHPrime && fHPrime < 4)
+	finishCloudMsg(g_foregroundmsg, points);
+
+	g_foregroundmsg.header.stamp = stamp;
+	publishCloud(foreground_publisher_, g_foregroundmsg);
+	g_foregroundsent = (points > 0);
+}
+
+void kanavi_node::publishDelta()
+{
+	// the reference is lost for whoever joins later, restart from a keyframe
+	if (delta_publisher_.getNumSubscribers() == 0)
 	{
-		*fR = 0;
-		*fG = fX;
-		*fB = fC;
+		m_delta->requestKeyframe();
+		return;
 	}
-	else if (0 <= fHPrime && fHPrime < 5)
+
+	const std::vector<uint8_t> &frame = m_delta->encode(kanavi_->getDatagram().len_buf);
+	g_deltamsg.data.assign(frame.begin(), frame.end());	// capacity is kept
+	delta_publisher_.publish(g_deltamsg);
+}
+
+void kanavi_node::publishZones(bool all)
+{
+	for (size_t i = 0; i < m_zone->size(); i++)
 	{
-		*fR = fX;
-		*fG = 0;
-		*fB = fC;
+		if (all || m_zone->isChanged(i))
+		{
+			g_zonemsg.data = m_zone->isOccupied(i);
+			zone_publishers_[i].publish(g_zonemsg);
+		}
 	}
-	else if (0 <= fHPrime && fHPrime < 6)
+}
+
+void kanavi_node::publishStatus()
+{
+	const kanaviStatus &status = kanavi_->getStatus();
+
+	// [0] detection, [1] flags, [2 ~] area configuration
+	g_statusmsg.data[0] = status.detection;
+	g_statusmsg.data[1] = status.flags;
+	std::copy(status.area_config, status.area_config + KANAVI::STATUS::AREA_CONFIG_SIZE, g_statusmsg.data.begin() + 2);
+	status_publisher_.publish(g_statusmsg);
+}
+
+void kanavi_node::publishClusters()
+{
+	const kanaviDatagram &datagram = kanavi_->getDatagram();
+
+	// rings in channel order, the projected rows are consumed right away
+	m_cluster->clear();
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
 	{
-		*fR = fC;
-		*fG = 0;
-		*fB = fX;
+		size_t cnt = projectChannel(datagram, ch);
+		if (cnt > 0)
+		{
+			m_cluster->insert(ch, g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(), g_valid.data(),
+							  static_cast<int>(cnt));
+		}
 	}
-	else
+	m_cluster->finish();
+
+	// capacity was reserved for a full frame
+	const std::vector<KANAVI::CLUSTER::cluster> &clusters = m_cluster->getClusters();
+	g_clustermsg.data.resize(clusters.size() * KANAVI::CLUSTER::FIELDS);
+
+	float *out = g_clustermsg.data.data();
+	for (const KANAVI::CLUSTER::cluster &c : clusters)
 	{
-		*fR = 0;
-		*fG = 0;
-		*fB = 0;
+		std::copy(c.centroid, c.centroid + 3, out);
+		std::copy(c.min, c.min + 3, out + 3);
+		std::copy(c.max, c.max + 3, out + 6);
+		out[9] = static_cast<float>(c.count);
+		out += KANAVI::CLUSTER::FIELDS;
 	}
+	g_clustermsg.layout.dim[0].size = static_cast<uint32_t>(clusters.size());
+	g_clustermsg.layout.dim[0].stride = static_cast<uint32_t>(clusters.size() * KANAVI::CLUSTER::FIELDS);
+
+	cluster_publisher_.publish(g_clustermsg);
 }
 
-sensor_msgs::PointCloud2 kanavi_node::cloud_to_cloud_msg(int ww, int hh, const pcl::PointCloud<pcl::PointXYZRGB> &cloud, int timestamp, const std::string &frame)
+void kanavi_node::publishAccumulated(const ros::Time &stamp)
 {
-	sensor_msgs::PointCloud2 msg{};
-	pcl::toROSMsg(cloud, msg);
+	// compensation needs a pose, frames before the first odometry are not kept
+	if (!odomTopic_.empty() && !m_accumulate->hasPose())
+	{
+		KANAVI_LOG_WARN_THROTTLE(1000, "[NODE] Waiting for odometry on %s\n", odomTopic_.c_str());
+		return;
+	}
 
-	// msg.header.stamp.fromNSec(100000000);
-	msg.header.stamp = ros::Time::now();
+	const kanaviDatagram &datagram = kanavi_->getDatagram();
+	size_t beams = static_cast<size_t>(m_projection->getBeams());
+	size_t step = m_acccloud->getPointStep();
+	uint8_t *slot = &g_accmsg.data[m_accumulate->begin() * step];
 
-	msg.header.frame_id = frame;
+	// the oldest row is overwritten in place, beams without a point become NaN
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
+	{
+		uint8_t *row = slot + ch * beams * step;
+		size_t cnt = projectChannel(datagram, ch);
+		if (cnt > 0)
+		{
+			m_accumulate->transform(g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), static_cast<int>(cnt));
+			m_acccloud->write(row, g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(), g_valid.data(),
+							  ch, static_cast<int>(cnt), *m_palette);
+		}
+		if (cnt < beams)
+		{
+			m_acccloud->writeInvalid(row + cnt * step, ch, static_cast<int>(cnt), static_cast<int>(beams - cnt));
+		}
+	}
 
-	return msg;
+	// the window is published as it lies in the ring, rows are not reordered
+	if (m_accumulate->end() && accumulate_publisher_.getNumSubscribers() > 0)
+	{
+		g_accmsg.header.stamp = stamp;
+		accumulate_publisher_.publish(g_accmsg);
+	}
 }
 
-void kanavi_node::rotateAxisZ(PointCloudT::Ptr cloud, float angle)
+void kanavi_node::odometryCallback(const nav_msgs::Odometry::ConstPtr &msg)
 {
-	float rad = pcl::deg2rad(angle);
-	Eigen::Matrix4f m_ = Eigen::Matrix4f::Identity();
-	m_(0, 0) = cos(rad);
-	m_(0, 1) = -sin(rad);
-	m_(1, 0) = sin(rad);
-	m_(1, 1) = cos(rad);
+	m_accumulate->setPose(msg->pose.pose.position.x, msg->pose.pose.position.y, msg->pose.pose.position.z,
+						  msg->pose.pose.orientation.x, msg->pose.pose.orientation.y, msg->pose.pose.orientation.z, msg->pose.pose.orientation.w);
 
-	pcl::transformPointCloud(*cloud, *cloud, m_);
-}
\ No newline at end of file
+	// points are written in the odometry frame from now on
+	g_accmsg.header.frame_id = msg->header.frame_id;
+}
@@ -0,0 +1,168 @@
+#include "ros2/kanavi_frame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const sensor_msgs::msg::PointField *findField(const sensor_msgs::msg::PointCloud2 &msg, const char *name)
+	{
+		for (const sensor_msgs::msg::PointField &f : msg.fields)
+		{
+			if (f.name == name)
+			{
+				return &f;
+			}
+		}
+		return nullptr;
+	}
+
+	float readField(const uint8_t *point, const sensor_msgs::msg::PointField &f)
+	{
+		if (f.datatype == KANAVI::CLOUD::FLOAT32)
+		{
+			float v;
+			memcpy(&v, point + f.offset, sizeof(v));
+			return v;
+		}
+		if (f.datatype == KANAVI::CLOUD::INT16)	// xyz16 [mm]
+		{
+			int16_t v;
+			memcpy(&v, point + f.offset, sizeof(v));
+			return v * 0.001f;
+		}
+		return NAN;
+	}
+
+	// readField() stays inside a point, unknown types are not read
+	bool fitsPoint(const sensor_msgs::msg::PointField *f, uint32_t point_step)
+	{
+		if (!f)
+		{
+			return true;
+		}
+		size_t size = (f->datatype == KANAVI::CLOUD::FLOAT32) ? sizeof(float) : (f->datatype == KANAVI::CLOUD::INT16) ? sizeof(int16_t) : 0;
+		return static_cast<size_t>(f->offset) + size <= point_step;
+	}
+}
+
+void kanaviFrameToCloud(const kanaviFrame &frame, sensor_msgs::msg::PointCloud2 &msg)
+{
+	msg.header = frame.header;
+	msg.fields.clear();
+	msg.data.clear();
+	msg.height = 1;
+	msg.width = 0;
+	msg.row_step = 0;
+	msg.is_bigendian = false;
+
+	if (!frame.projection || !frame.layout || !frame.palette)
+	{
+		msg.point_step = 0;
+		msg.is_dense = true;
+		return;
+	}
+
+	const kanavi_cloud &layout = *frame.layout;
+	for (const KANAVI::CLOUD::field &f : layout.getFields())
+	{
+		sensor_msgs::msg::PointField field;
+		field.name = f.name;
+		field.offset = f.offset;
+		field.datatype = f.datatype;
+		field.count = f.count;
+		msg.fields.push_back(field);
+	}
+	msg.point_step = layout.getPointStep();
+	msg.is_dense = !layout.isOrganized();
+
+	int channels = std::min(frame.channels, frame.projection->getChannels());
+	int beams = std::min(frame.beams, frame.projection->getBeams());
+	if (channels <= 0 || beams <= 0)
+	{
+		return;
+	}
+
+	// same rows as the frame topic, projected only now
+	std::vector<float> x(beams), y(beams), z(beams);
+	std::vector<uint8_t> valid(beams);
+	size_t step = msg.point_step;
+	msg.data.resize(static_cast<size_t>(channels) * beams * step);
+
+	size_t points = 0;
+	for (int ch = 0; ch < channels; ch++)
+	{
+		const float *len = frame.row(ch);
+		for (int i = 0; i < beams; i++)
+		{
+			valid[i] = (len[i] > 0) ? 1 : 0;
+		}
+		frame.projection->project(len, ch, beams, x.data(), y.data(), z.data());
+
+		size_t written = layout.write(&msg.data[points * step], x.data(), y.data(), z.data(), len, valid.data(), ch, beams, *frame.palette);
+		if (layout.isOrganized() && written < static_cast<size_t>(beams))
+		{
+			layout.writeInvalid(&msg.data[(points + written) * step], ch, static_cast<int>(written), beams - static_cast<int>(written));
+			written = beams;
+		}
+		points += written;
+	}
+
+	msg.height = layout.isOrganized() ? channels : 1;
+	msg.width = layout.isOrganized() ? beams : static_cast<uint32_t>(points);
+	msg.row_step = msg.width * msg.point_step;
+	msg.data.resize(static_cast<size_t>(msg.row_step) * msg.height);
+}
+
+void kanaviCloudToFrame(const sensor_msgs::msg::PointCloud2 &msg, kanaviFrame &frame)
+{
+	frame.header = msg.header;
+	frame.projection.reset();
+	frame.layout.reset();
+	frame.palette.reset();
+	frame.channels = 0;
+	frame.beams = 0;
+	frame.ranges.clear();
+
+	// a ring / beam grid is needed to place the ranges
+	bool organized = (msg.height > 1 || !msg.is_dense);
+	if (!organized || msg.data.size() < static_cast<size_t>(msg.row_step) * msg.height)
+	{
+		return;
+	}
+
+	const sensor_msgs::msg::PointField *range = findField(msg, "range");
+	const sensor_msgs::msg::PointField *x = findField(msg, "x");
+	const sensor_msgs::msg::PointField *y = findField(msg, "y");
+	const sensor_msgs::msg::PointField *z = findField(msg, "z");
+	if (!range && !(x && y && z))
+	{
+		return;
+	}
+
+	// any publisher's cloud arrives here, its layout is checked before reading
+	if (static_cast<size_t>(msg.row_step) < static_cast<size_t>(msg.width) * msg.point_step ||
+		!fitsPoint(range, msg.point_step) || !fitsPoint(x, msg.point_step) || !fitsPoint(y, msg.point_step) || !fitsPoint(z, msg.point_step))
+	{
+		return;
+	}
+
+	frame.channels = static_cast<int>(msg.height);
+	frame.beams = static_cast<int>(msg.width);
+	frame.ranges.resize(static_cast<size_t>(msg.height) * msg.width);
+
+	for (uint32_t ch = 0; ch < msg.height; ch++)
+	{
+		for (uint32_t i = 0; i < msg.width; i++)
+		{
+			const uint8_t *point = &msg.data[static_cast<size_t>(ch) * msg.row_step + static_cast<size_t>(i) * msg.point_step];
+
+			// without a range field the mounting pose is assumed at the origin
+			float r = range ? readField(point, *range)
+							: std::sqrt(readField(point, *x) * readField(point, *x) + readField(point, *y) * readField(point, *y) +
+										readField(point, *z) * readField(point, *z));
+			frame.ranges[static_cast<size_t>(ch) * msg.width + i] = (std::isfinite(r) && r > 0) ? r : 0.0f;
+		}
+	}
+}
@@ -1,9 +1,103 @@
 #include "ros2/kanavi_node.h"
+#include "kanavi_log.h"
 
-kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_) : rclcpp::Node(node_)
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_) : rclcpp::Node(node_), running_(true)
+{
+	intra_process_ = false;
+	initialize(node_, argc_, argv_);
+}
+
+kanavi_node::kanavi_node(const rclcpp::NodeOptions &options) : rclcpp::Node("kanavi_vl", options), running_(true)
+{
+	// the whole frame changes hands instead of being copied per subscriber
+	intra_process_ = options.use_intra_process_comms();
+
+	std::string model = this->declare_parameter<std::string>("model", "r270");
+	if (model != "r270" && model != "r4" && model != "r2")
+	{
+		throw std::runtime_error("unknown model '" + model + "' (r2, r4, r270)");
+	}
+
+	std::vector<std::string> args = parametersToArgv();
+	std::vector<char *> argv;
+	for (std::string &arg : args)
+	{
+		argv.push_back(&arg[0]);
+	}
+	int argc = static_cast<int>(argv.size());
+	argv.push_back(nullptr);
+	initialize(model, argc, argv.data());
+}
+
+std::vector<std::string> kanavi_node::parametersToArgv()
+{
+	const std::string options[] = {
+		KANAVI::ROS::PARAMETER_TOPIC, KANAVI::ROS::PARAMETER_FIXED, KANAVI::ROS::PARAMETER_IP,
+		KANAVI::ROS::PARAMETER_Multicast, KANAVI::ROS::PARAMETER_STREAM, KANAVI::ROS::PARAMETER_COLOR,
+		KANAVI::ROS::PARAMETER_COLOR_RANGE, KANAVI::ROS::PARAMETER_LAYOUT, KANAVI::ROS::PARAMETER_STREAM_LAYOUT,
+		KANAVI::ROS::PARAMETER_ORGANIZED, KANAVI::ROS::PARAMETER_RANGE_IMAGE, KANAVI::ROS::PARAMETER_SCAN,
+		KANAVI::ROS::PARAMETER_CALIBRATION, KANAVI::ROS::PARAMETER_POSE, KANAVI::ROS::PARAMETER_POSE_TF,
+		KANAVI::ROS::PARAMETER_SENSOR_FRAME, KANAVI::ROS::PARAMETER_RANGE, KANAVI::ROS::PARAMETER_AZIMUTH,
+		KANAVI::ROS::PARAMETER_CHANNELS, KANAVI::ROS::PARAMETER_CROP_BOX, KANAVI::ROS::PARAMETER_VOXEL, KANAVI::ROS::PARAMETER_TEMPORAL,
+		KANAVI::ROS::PARAMETER_BACKGROUND, KANAVI::ROS::PARAMETER_DELTA, KANAVI::ROS::PARAMETER_ZONES,
+		KANAVI::ROS::PARAMETER_STATUS, KANAVI::ROS::PARAMETER_CLUSTER, KANAVI::ROS::PARAMETER_ACCUMULATE,
+		KANAVI::ROS::PARAMETER_FRAME, KANAVI::ROS::PARAMETER_RANGES};
+
+	// any type is accepted : "true" = option without values, "false" / empty = not set, lists = values
+	rcl_interfaces::msg::ParameterDescriptor descriptor;
+	descriptor.dynamic_typing = true;
+
+	std::vector<std::string> args = {this->get_name()};
+	for (const std::string &option : options)
+	{
+		std::string name = option.substr(1);
+		rclcpp::ParameterValue value = this->declare_parameter(name, rclcpp::ParameterValue(std::string()), descriptor);
+
+		std::string text = (value.get_type() == rclcpp::ParameterType::PARAMETER_STRING) ? value.get<std::string>()
+																						   : rclcpp::to_string(value);
+		if (text.empty() || text == "false")
+		{
+			continue;
+		}
+		args.push_back(option);
+		if (text == "true")
+		{
+			continue;
+		}
+
+		// "[1.0, 2.0]" -> "1.0 2.0"
+		std::replace_if(text.begin(), text.end(), [](char c) { return c == '[' || c == ']' || c == ','; }, ' ');
+		std::istringstream ss(text);
+		std::string token;
+		while (ss >> token)
+		{
+			args.push_back(token);
+		}
+	}
+	return args;
+}
+
+void kanavi_node::initialize(const std::string &node_, int &argc_, char **argv_)
 {
 	checked_multicast_ = false;
 	checked_help_ = false;
+	checked_stream_ = false;
+	checked_organized_ = false;
+	checked_scan_ = false;
+	g_calibcheck = 0;
+	checked_background_ = false;
+	g_foregroundsent = false;
+	checked_delta_ = false;
+	checked_status_ = false;
+	checked_cluster_ = false;
+	accumulateFrames_ = 0;
+	checked_frame_ = false;
+	checked_ranges_ = false;
+	g_laststamp = 0;
 
 	// check help
 	for(int i=0; i<argc_; i++)
@@ -33,17 +127,61 @@ kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_) : r
 		topicName_ = argvs.topicName;
 		fixedName_ = argvs.fixedName;
 		checked_multicast_ = argvs.checked_multicast;
+		checked_stream_ = argvs.checked_stream;
+		checked_organized_ = argvs.checked_organized;
+		checked_scan_ = argvs.checked_scan;
+		colorName_ = argvs.colorName;
+		colorRange_ = argvs.colorRange;
+		layoutName_ = argvs.layout;
+		streamLayoutName_ = argvs.streamLayout.empty() ? argvs.layout : argvs.streamLayout;
+		rangeImageUnit_ = argvs.rangeImageUnit;
+		calibPath_ = argvs.calibPath;
+		pose_ = argvs.pose;
+		crop_ = argvs.crop;
+		voxelSize_ = argvs.voxelSize;
+		voxelPolicy_ = argvs.voxelPolicy;
+		temporalMode_ = argvs.temporalMode;
+		temporalFrames_ = argvs.temporalFrames;
+		temporalTolerance_ = argvs.temporalTolerance;
+		checked_background_ = argvs.checked_background;
+		backgroundTolerance_ = argvs.backgroundTolerance;
+		backgroundFrames_ = argvs.backgroundFrames;
+		backgroundMinBeams_ = argvs.backgroundMinBeams;
+		checked_delta_ = argvs.checked_delta;
+		deltaThreshold_ = argvs.deltaThreshold;
+		deltaInterval_ = argvs.deltaInterval;
+		zonePath_ = argvs.zonePath;
+		checked_status_ = argvs.checked_status;
+		checked_cluster_ = argvs.checked_cluster;
+		clusterRangeJump_ = argvs.clusterRangeJump;
+		clusterAngularGap_ = argvs.clusterAngularGap;
+		clusterMinPoints_ = argvs.clusterMinPoints;
+		accumulateFrames_ = argvs.accumulateFrames;
+		accumulateDecimation_ = argvs.accumulateDecimation;
+		odomTopic_ = argvs.odomTopic;
+		checked_frame_ = argvs.checked_frame;
+		checked_ranges_ = argvs.checked_ranges;
+		poseFrame_ = argvs.poseFrame;
+		sensorName_ = !argvs.sensorFrame.empty() ? argvs.sensorFrame : (!poseFrame_.empty() ? poseFrame_ : fixedName_);
 
-		if(checked_multicast_)
+		try
 		{
-			multicast_ip_ = argvs.multicast_ip;
-			// init UDP network
-			m_udp = std::make_unique<kanavi_udp>(local_ip_, port_, multicast_ip_);
+			if(checked_multicast_)
+			{
+				multicast_ip_ = argvs.multicast_ip;
+				// init UDP network
+				m_udp = std::make_unique<kanavi_udp>(local_ip_, port_, multicast_ip_);
+			}
+			else
+			{
+				// init UDP network
+				m_udp = std::make_unique<kanavi_udp>(local_ip_, port_);
+			}
 		}
-		else
+		catch (const std::exception &e)
 		{
-			// init UDP network
-			m_udp = std::make_unique<kanavi_udp>(local_ip_, port_);
+			printf("[NODE] %s, receive disabled\n", e.what());
+			return;
 		}
 
 		if(m_udp->connect() == -1)
@@ -76,24 +214,324 @@ kanavi_node::kanavi_node(const std::string &node_, int &argc_, char **argv_) : r
 			return;
 		}
 
+		// mounting pose : a static TF overrides -pose
+		if (!poseFrame_.empty())
+		{
+			lookupPose();
+		}
+
 		calculateAngular(model_);
 
+		// range / azimuth / channel / box crop, precomputed per beam
+		if (crop_.isActive())
+		{
+			m_crop = std::make_unique<kanavi_crop>(crop_, *m_projection);
+		}
+
+		// intrinsic calibration, applied once the sender of the first packet is known
+		if (!calibPath_.empty())
+		{
+			try
+			{
+				m_calibration = std::make_unique<kanavi_calibration>(calibPath_);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, specification is used\n", e.what());
+			}
+		}
+
+		// per-beam temporal filter over the last frames
+		if (!temporalMode_.empty())
+		{
+			try
+			{
+				m_temporal = std::make_unique<kanavi_temporal>(temporalMode_, temporalFrames_, temporalTolerance_,
+															   m_projection->getChannels(), m_projection->getBeams());
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, temporal filter disabled\n", e.what());
+			}
+		}
+
+		// range -> color table
+		try
+		{
+			m_palette = std::make_unique<kanavi_palette>(colorName_, colorRange_);
+		}
+		catch (const std::exception &e)
+		{
+			printf("[NODE] %s, fall back to %s\n", e.what(), KANAVI::PALETTE::HSV.c_str());
+			m_palette = std::make_unique<kanavi_palette>(KANAVI::PALETTE::HSV, KANAVI::PALETTE::DEFAULT_RANGE);
+		}
+
 		// init LiDAR Processor 
 		m_process = std::make_unique<kanavi_lidar>(model_);
 
-		g_pointcloud.reset(new PointCloudT);
+		// init. PointCloud2 layout & reused messages
+		m_cloud = createLayout(layoutName_);
+		m_channelcloud = createLayout(streamLayoutName_);
+		initCloudMsg(g_cloudmsg, *m_cloud, static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams());
+		initCloudMsg(g_channelmsg, *m_channelcloud, m_projection->getBeams());
 
 		// init
 		auto qos_profile = rclcpp::QoS(rclcpp::KeepLast(10));
+
+		// latched topics : transient_local is refused together with intra-process, they always go through the middleware
+		auto latched_qos = rclcpp::QoS(rclcpp::KeepLast(1)).transient_local();
+		rclcpp::PublisherOptions latched_options;
+		latched_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
 		publisher_ = this->create_publisher<sensor_msgs::msg::PointCloud2>(topicName_, qos_profile);
 
-		// active UDP RECV using timer
-		timer_ = this->create_wall_timer(std::chrono::microseconds(500), std::bind(&kanavi_node::receiveData, this));
+		// only R4 decodes a frame channel by channel, R2 / R270 never finish a single channel
+		if (checked_stream_ && model_ != KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4)
+		{
+			printf("[NODE] %s is only supported by R4, channel stream disabled\n", KANAVI::ROS::PARAMETER_STREAM.c_str());
+			checked_stream_ = false;
+		}
+
+		if (checked_stream_)
+		{
+			for (int ch = 0; ch < m_projection->getChannels(); ch++)
+			{
+				channel_publishers_.push_back(this->create_publisher<sensor_msgs::msg::PointCloud2>(topicName_ + "_ch" + std::to_string(ch), qos_profile));
+			}
+		}
+
+		// range image : channels x beams, no projection
+		if (!rangeImageUnit_.empty())
+		{
+			try
+			{
+				m_image = std::make_unique<kanavi_image>(rangeImageUnit_, m_projection->getChannels(), m_projection->getBeams());
+
+				g_imagemsg.header.set__frame_id(sensorName_);
+				g_imagemsg.height = m_image->getHeight();
+				g_imagemsg.width = m_image->getWidth();
+				g_imagemsg.encoding = sensor_msgs::image_encodings::MONO16;
+				g_imagemsg.is_bigendian = 0;
+				g_imagemsg.step = m_image->getStep();
+				g_imagemsg.data.resize(static_cast<size_t>(g_imagemsg.step) * g_imagemsg.height);
+
+				image_publisher_ = this->create_publisher<sensor_msgs::msg::Image>(topicName_ + "_range_image", qos_profile);
+				angle_publisher_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(topicName_ + "_beam_angles",
+																							 latched_qos, latched_options);
+				publishBeamAngles();
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, range image disabled\n", e.what());
+			}
+		}
+
+		// LaserScan : R270 as is, R2/R4 one scan per ring
+		if (checked_scan_)
+		{
+			updateScanAngles();
+
+			g_scanmsg.header.set__frame_id(sensorName_);
+			g_scanmsg.time_increment = 0;
+			g_scanmsg.range_min = KANAVI::SCAN::RANGE_MIN;
+			g_scanmsg.range_max = KANAVI::SCAN::RANGE_MAX;
+			g_scanmsg.ranges.resize(m_scan->getBeams());
+
+			for (int ch = 0; ch < m_projection->getChannels(); ch++)
+			{
+				std::string suffix = (m_projection->getChannels() == 1) ? "_scan" : "_scan_ch" + std::to_string(ch);
+				scan_publishers_.push_back(this->create_publisher<sensor_msgs::msg::LaserScan>(topicName_ + suffix, qos_profile));
+			}
+		}
+
+		// voxel grid downsampling on its own topic
+		if (voxelSize_ > 0)
+		{
+			try
+			{
+				size_t capacity = static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams();
+				m_voxel = std::make_unique<kanavi_voxel>(voxelSize_, voxelPolicy_, capacity);
+
+				// a voxel has no single ring / beam
+				const std::string &layout = (m_cloud->getLayout() == KANAVI::CLOUD::XYZRBR) ? KANAVI::CLOUD::LAYOUT_XYZ : m_cloud->getName();
+				m_voxelcloud = std::make_unique<kanavi_cloud>(layout, false);
+				initCloudMsg(g_voxelmsg, *m_voxelcloud, capacity);
+
+				voxel_publisher_ = this->create_publisher<sensor_msgs::msg::PointCloud2>(topicName_ + "_voxel", qos_profile);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, voxel grid disabled\n", e.what());
+			}
+		}
+
+		// learned static background, only the beams in front of it are published
+		if (checked_background_)
+		{
+			try
+			{
+				m_background = std::make_unique<kanavi_background>(backgroundTolerance_, backgroundFrames_, backgroundMinBeams_,
+																   m_projection->getChannels(), m_projection->getBeams());
+
+				// xyzrbr keeps the beam index & range of every foreground point
+				m_foregroundcloud = std::make_unique<kanavi_cloud>(m_cloud->getName(), false);
+				initCloudMsg(g_foregroundmsg, *m_foregroundcloud, static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams());
+
+				foreground_publisher_ = this->create_publisher<sensor_msgs::msg::PointCloud2>(topicName_ + "_foreground", qos_profile);
+				activity_publisher_ = this->create_publisher<std_msgs::msg::Bool>(topicName_ + "_activity", qos_profile);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, background model disabled\n", e.what());
+			}
+		}
+
+		// compact keyframe + delta frames for thin links
+		if (checked_delta_)
+		{
+			try
+			{
+				m_delta = std::make_unique<kanavi_delta_encoder>(m_projection->getChannels(), m_projection->getBeams(),
+																 deltaThreshold_, deltaInterval_);
+				delta_publisher_ = this->create_publisher<std_msgs::msg::UInt8MultiArray>(topicName_ + "_delta", qos_profile);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, delta frames disabled\n", e.what());
+			}
+		}
+
+		// polygon intrusion zones, compiled into per-beam range intervals
+		if (!zonePath_.empty())
+		{
+			try
+			{
+				m_zone = std::make_unique<kanavi_zone>(zonePath_);
+				m_zone->compile(*m_projection);
+
+				for (size_t i = 0; i < m_zone->size(); i++)
+				{
+					std::string name = topicName_ + "_zone_" + m_zone->getName(i);
+					zone_publishers_.push_back(this->create_publisher<std_msgs::msg::Bool>(name, latched_qos, latched_options));
+				}
+				publishZones(true);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, zones disabled\n", e.what());
+			}
+		}
+
+		// detection bits & area configuration, decoded in the parse pass
+		if (checked_status_)
+		{
+			status_publisher_ = this->create_publisher<std_msgs::msg::UInt8MultiArray>(topicName_ + "_status", latched_qos, latched_options);
+			g_statusmsg.data.resize(2 + KANAVI::STATUS::AREA_CONFIG_SIZE);
+		}
+
+		// objects segmented in one pass along scan order
+		if (checked_cluster_)
+		{
+			try
+			{
+				m_cluster = std::make_unique<kanavi_cluster>(clusterRangeJump_, clusterAngularGap_, clusterMinPoints_,
+															 m_projection->getChannels(), m_projection->getBeams(), m_projection->getHorizontalResolution());
+
+				g_clustermsg.layout.dim.resize(2);
+				g_clustermsg.layout.dim[0].label = "clusters";
+				g_clustermsg.layout.dim[1].label = "fields";	// centroid xyz, min xyz, max xyz, count
+				g_clustermsg.layout.dim[1].size = KANAVI::CLUSTER::FIELDS;
+				g_clustermsg.layout.dim[1].stride = KANAVI::CLUSTER::FIELDS;
+				g_clustermsg.data.reserve(static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams() * KANAVI::CLUSTER::FIELDS);
+
+				cluster_publisher_ = this->create_publisher<std_msgs::msg::Float32MultiArray>(topicName_ + "_clusters", qos_profile);
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, clustering disabled\n", e.what());
+			}
+		}
+
+		// sliding window of the last frames for sparse sensors
+		if (accumulateFrames_ > 0)
+		{
+			try
+			{
+				size_t capacity = static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams();
+				m_accumulate = std::make_unique<kanavi_accumulate>(accumulateFrames_, accumulateDecimation_, capacity);
+
+				// organized, a row per frame keeps every frame at a fixed place in the buffer
+				m_acccloud = std::make_unique<kanavi_cloud>(m_cloud->getName(), true);
+				initCloudMsg(g_accmsg, *m_acccloud, capacity * accumulateFrames_);
+				finishCloudMsg(g_accmsg, capacity, accumulateFrames_);
+
+				// every row starts without points
+				size_t beams = static_cast<size_t>(m_projection->getBeams());
+				for (size_t row = 0; row < static_cast<size_t>(accumulateFrames_) * m_projection->getChannels(); row++)
+				{
+					m_acccloud->writeInvalid(&g_accmsg.data[row * beams * m_acccloud->getPointStep()],
+											 static_cast<int>(row % m_projection->getChannels()), 0, static_cast<int>(beams));
+				}
+
+				accumulate_publisher_ = this->create_publisher<sensor_msgs::msg::PointCloud2>(topicName_ + "_accumulated", qos_profile);
+				if (!odomTopic_.empty())
+				{
+					odom_subscriber_ = this->create_subscription<nav_msgs::msg::Odometry>(odomTopic_, rclcpp::QoS(rclcpp::KeepLast(10)),
+																						  std::bind(&kanavi_node::odometryCallback, this, std::placeholders::_1));
+				}
+			}
+			catch (const std::exception &e)
+			{
+				printf("[NODE] %s, accumulation disabled\n", e.what());
+			}
+		}
+
+		// native frames, same-process subscribers get the ranges without a cloud being written
+		if (checked_frame_)
+		{
+#if KANAVI_TYPE_ADAPTER
+			frame_publisher_ = this->create_publisher<rclcpp::TypeAdapter<kanaviFrame, sensor_msgs::msg::PointCloud2>>(topicName_ + "_frame", qos_profile);
+#else
+			printf("[NODE] type adaptation needs rclcpp >= Humble, native frames disabled\n");
+			checked_frame_ = false;
+#endif
+		}
+
+		// fixed-size range frames, no serialization & no copy on a shared-memory middleware
+		if (checked_ranges_)
+		{
+			size_t points = static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams();
+			if (points > kanavi_vl::msg::RangeFrame::MAX_POINTS)
+			{
+				printf("[NODE] %zu points exceed RangeFrame::MAX_POINTS, range frames disabled\n", points);
+				checked_ranges_ = false;
+			}
+			else
+			{
+				ranges_publisher_ = this->create_publisher<kanavi_vl::msg::RangeFrame>(topicName_ + "_ranges", qos_profile);
+			}
+		}
+
+		// active UDP RECV on a node-owned thread, a container executor is not blocked by recvfrom
+		receive_thread_ = std::thread(&kanavi_node::receiveLoop, this);
 	}
 }
 
 kanavi_node::~kanavi_node()
 {
+	// recvfrom returns within the socket timeout
+	running_ = false;
+	if (receive_thread_.joinable())
+	{
+		receive_thread_.join();
+	}
+}
+
+void kanavi_node::receiveLoop()
+{
+	while (rclcpp::ok() && running_)
+	{
+		receiveData();
+	}
 }
 
 void kanavi_node::helpAlarm()
@@ -105,30 +543,143 @@ void kanavi_node::helpAlarm()
 		"\t ex) %s [ip]\n"
 		"%s : set fixed frame Name for rviz\n"
 		"%s : set topic name for rviz\n"
-		, KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_FIXED.c_str(), KANAVI::ROS::PARAMETER_TOPIC.c_str());	
+		"%s : publish each channel as soon as it is decoded (R4)\n"
+		"%s : set point color palette (hsv, gray, none)\n"
+		"%s : set distance of one palette span [m]\n"
+		"%s : set point layout (xyz, xyzrgb, xyzrbr, xyz16)\n"
+		"%s : set point layout of the channel stream\n"
+		"%s : organized cloud (height = channels, width = beams, NaN = no return)\n"
+		"%s : publish 16-bit range image (cm, mm)\n"
+		"%s : publish LaserScan (R270 : one scan, R2/R4 : one scan per ring)\n"
+		"%s : set intrinsic calibration file (reloaded on change)\n"
+		"%s : set mounting pose in the fixed frame [m, deg]\n"
+		"\t ex) %s [x] [y] [z] [roll] [pitch] [yaw]\n"
+		"%s : look up the mounting pose from a static TF (sensor frame)\n"
+		"%s : set frame ID of the range image & LaserScan (default : -pose_tf frame, else -fix)\n"
+		"%s : keep measured ranges within [min] [max] [m]\n"
+		"%s : keep azimuths within [min] [max] [deg]\n"
+		"%s : keep listed channels only (ex. 0,1,3)\n"
+		"%s : keep points inside a box [xmin] [ymin] [zmin] [xmax] [ymax] [zmax] [m]\n"
+		"%s : publish voxel grid downsampled cloud [leaf m] [centroid|first]\n"
+		"%s : filter ranges over the last frames [median|persistence] [frames] [tolerance m]\n"
+		"%s : publish beams in front of the learned background [tolerance m] [frames] [min beams]\n"
+		"%s : publish keyframe + delta encoded frames [threshold m] [keyframe interval]\n"
+		"%s : set intrusion zone file (polygons, state published on change)\n"
+		"%s : publish sensor detection bits & area configuration (on change)\n"
+		"%s : publish scan-order clusters [range jump m] [angular gap deg] [min points]\n"
+		"%s : publish the last frames together [frames] [publish every N frames] [odometry topic]\n"
+		"%s : publish native frames, PointCloud2 written only for subscribers that need it\n"
+		"%s : publish fixed-size range frames, loaned from the middleware (shared memory)\n"
+		, KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_IP.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_Multicast.c_str(), KANAVI::ROS::PARAMETER_FIXED.c_str(), KANAVI::ROS::PARAMETER_TOPIC.c_str()
+		, KANAVI::ROS::PARAMETER_STREAM.c_str(), KANAVI::ROS::PARAMETER_COLOR.c_str(), KANAVI::ROS::PARAMETER_COLOR_RANGE.c_str()
+		, KANAVI::ROS::PARAMETER_LAYOUT.c_str(), KANAVI::ROS::PARAMETER_STREAM_LAYOUT.c_str(), KANAVI::ROS::PARAMETER_ORGANIZED.c_str(), KANAVI::ROS::PARAMETER_RANGE_IMAGE.c_str(), KANAVI::ROS::PARAMETER_SCAN.c_str()
+		, KANAVI::ROS::PARAMETER_CALIBRATION.c_str(), KANAVI::ROS::PARAMETER_POSE.c_str(), KANAVI::ROS::PARAMETER_POSE.c_str(), KANAVI::ROS::PARAMETER_POSE_TF.c_str(), KANAVI::ROS::PARAMETER_SENSOR_FRAME.c_str()
+		, KANAVI::ROS::PARAMETER_RANGE.c_str(), KANAVI::ROS::PARAMETER_AZIMUTH.c_str(), KANAVI::ROS::PARAMETER_CHANNELS.c_str(), KANAVI::ROS::PARAMETER_CROP_BOX.c_str()
+		, KANAVI::ROS::PARAMETER_VOXEL.c_str(), KANAVI::ROS::PARAMETER_TEMPORAL.c_str(), KANAVI::ROS::PARAMETER_BACKGROUND.c_str(), KANAVI::ROS::PARAMETER_DELTA.c_str(), KANAVI::ROS::PARAMETER_ZONES.c_str()
+		, KANAVI::ROS::PARAMETER_STATUS.c_str(), KANAVI::ROS::PARAMETER_CLUSTER.c_str(), KANAVI::ROS::PARAMETER_ACCUMULATE.c_str()
+		, KANAVI::ROS::PARAMETER_FRAME.c_str(), KANAVI::ROS::PARAMETER_RANGES.c_str());
 }
 
 void kanavi_node::receiveData()
 {
 	// recv data using udp
 	std::vector<u_char> recv_buf = m_udp->getData();
-	RCLCPP_INFO(this->get_logger(), "Received data size: %ld", recv_buf.size());
+	KANAVI_LOG_DEBUG("[NODE] Received data size: %zu\n", recv_buf.size());
+
+	// the frame-end flag stays set until the next CH0, only the packet completing the frame hands it over
+	bool checked_frame_end = false;
 
 	if(recv_buf.size() > 0)
 	{
-		g_datagram = m_process->process(recv_buf);
+		rclcpp::Time recv_stamp = this->get_clock()->now();
+
+		updateCalibration();
+
+		checked_frame_end = m_process->process(recv_buf) == KANAVI::PROCESS::InputMode::SUCCESS && m_process->checkedProcessEnd();
+
+		// sensor outputs at packet rate, no cloud needed
+		if (checked_status_ && m_process->checkedStatusChanged())
+		{
+			publishStatus();
+		}
+
+		// stream the decoded channel without waiting for the whole frame
+		if (checked_stream_ && m_process->checkedChannelEnd())
+		{
+			publishChannel(m_process->getLastChannel(), recv_stamp);
+		}
 	}
 
-	if(m_process->checkedProcessEnd())
+	if(checked_frame_end)
 	{
+		rclcpp::Time stamp = this->get_clock()->now();
+
+		// every frame goes through the ring, the outputs below see filtered ranges
+		if (m_temporal)
+		{
+			m_temporal->filter(m_process->getMutableDatagram().len_buf);
+		}
+
+		// zones first, one pass of range compares before any projection
+		if (m_zone && m_zone->evaluate(m_process->getDatagram().len_buf))
+		{
+			publishZones(false);
+		}
+
+		// projection only runs when someone listens to the cloud
+		if (publisher_->get_subscription_count() + publisher_->get_intra_process_subscription_count() > 0 || (!m_image && !m_scan && !m_voxel && !m_cluster))
+		{
+			length2PointCloud(m_process->getDatagram());
+
+			publish_pointcloud(stamp);
+		}
+
+		if (m_image)
+		{
+			publishRangeImage(stamp);
+		}
+
+		if (m_scan)
+		{
+			publishScan(stamp);
+		}
 
-		length2PointCloud(m_process->getDatagram());
+		// downsampling only runs when someone listens
+		if (m_voxel && voxel_publisher_->get_subscription_count() + voxel_publisher_->get_intra_process_subscription_count() > 0)
+		{
+			publishVoxel(stamp);
+		}
+
+		if (m_cluster && cluster_publisher_->get_subscription_count() + cluster_publisher_->get_intra_process_subscription_count() > 0)
+		{
+			publishClusters();
+		}
 
-		rotateAxisZ(g_pointcloud, rotate_angle);
+		if (m_accumulate)
+		{
+			publishAccumulated(stamp);
+		}
 
-		publish_pointcloud(g_pointcloud);
+		if (checked_frame_)
+		{
+			publishFrame(stamp);
+		}
+
+		if (checked_ranges_)
+		{
+			publishRanges(stamp);
+		}
+
+		// learned every frame, listeners or not
+		if (m_background)
+		{
+			publishForeground(stamp);
+		}
 
-		g_pointcloud->clear();
+		if (m_delta)
+		{
+			publishDelta();
+		}
 	}
 
 	recv_buf.clear();
@@ -158,178 +709,751 @@ void kanavi_node::log_set_parameters()
 	}
 	printf("Fixed Frame Name :\t%s\n", fixedName_.c_str());
 	printf("Topic Name :\t%s\n", topicName_.c_str());
+	if (checked_stream_)
+	{
+		printf("Channel Stream :\t%s_ch*\n", topicName_.c_str());
+	}
+	printf("Color Palette :\t%s (%.1f m)\n", colorName_.c_str(), colorRange_);
+	printf("Point Layout :\t%s%s\n", layoutName_.c_str(), checked_organized_ ? " (organized)" : "");
+	if (!rangeImageUnit_.empty())
+	{
+		printf("Range Image :\t%s_range_image [%s]\n", topicName_.c_str(), rangeImageUnit_.c_str());
+	}
+	if (checked_scan_)
+	{
+		printf("Laser Scan :\t%s_scan*\n", topicName_.c_str());
+	}
+	if (checked_stream_)
+	{
+		printf("Stream Layout :\t%s\n", streamLayoutName_.c_str());
+	}
+	if (!calibPath_.empty())
+	{
+		printf("Calibration :\t%s\n", calibPath_.c_str());
+	}
+	if (!poseFrame_.empty())
+	{
+		printf("Mounting Pose :\tTF %s -> %s\n", poseFrame_.c_str(), fixedName_.c_str());
+	}
+	else
+	{
+		printf("Mounting Pose :\t%.3f %.3f %.3f [m] %.2f %.2f %.2f [deg]\n", pose_.x, pose_.y, pose_.z, pose_.roll, pose_.pitch, pose_.yaw);
+	}
+	if (!rangeImageUnit_.empty() || checked_scan_)
+	{
+		printf("Sensor Frame Name :\t%s\n", sensorName_.c_str());
+	}
+	if (crop_.isActive())
+	{
+		printf("Crop :\trange %.2f ~ %.2f [m], azimuth %.1f ~ %.1f [deg], %s channels%s\n", crop_.range_min, crop_.range_max,
+			   crop_.azimuth_min, crop_.azimuth_max, crop_.channels.empty() ? "all" : "selected", crop_.box ? ", box" : "");
+	}
+	if (voxelSize_ > 0)
+	{
+		printf("Voxel Grid :\t%s_voxel [%.3f m, %s]\n", topicName_.c_str(), voxelSize_, voxelPolicy_.c_str());
+	}
+	if (!temporalMode_.empty())
+	{
+		printf("Temporal Filter :\t%s [%d frames, %.2f m]\n", temporalMode_.c_str(), temporalFrames_, temporalTolerance_);
+	}
+	if (checked_background_)
+	{
+		printf("Background :\t%s_foreground, %s_activity [%.2f m, %d frames, %d beams]\n", topicName_.c_str(), topicName_.c_str(),
+			   backgroundTolerance_, backgroundFrames_, backgroundMinBeams_);
+	}
+	if (checked_delta_)
+	{
+		printf("Delta Frames :\t%s_delta [%.3f m, keyframe every %d]\n", topicName_.c_str(), deltaThreshold_, deltaInterval_);
+	}
+	if (!zonePath_.empty())
+	{
+		printf("Zones :\t%s -> %s_zone_*\n", zonePath_.c_str(), topicName_.c_str());
+	}
+	if (checked_status_)
+	{
+		printf("Status :\t%s_status\n", topicName_.c_str());
+	}
+	if (checked_cluster_)
+	{
+		printf("Clusters :\t%s_clusters [%.2f m, %.2f deg, %d points]\n", topicName_.c_str(), clusterRangeJump_, clusterAngularGap_, clusterMinPoints_);
+	}
+	if (accumulateFrames_ > 0)
+	{
+		printf("Accumulation :\t%s_accumulated [%d frames, every %d, odometry %s]\n", topicName_.c_str(), accumulateFrames_, accumulateDecimation_,
+			   odomTopic_.empty() ? "none" : odomTopic_.c_str());
+	}
+	if (checked_frame_)
+	{
+		printf("Native Frames :\t%s_frame\n", topicName_.c_str());
+	}
+	if (checked_ranges_)
+	{
+		printf("Range Frames :\t%s_ranges\n", topicName_.c_str());
+	}
 	printf("--------------------------------\n");
 }
 
 void kanavi_node::calculateAngular(int model)
 {
-	switch (model)
+	// unit direction per (channel, beam) with BASE_ZERO_ANGLE folded in
+	m_projection = std::make_unique<kanavi_projection>(model, rotate_angle, KANAVI::CALIBRATION::intrinsic(), pose_);
+
+	g_proj_x.resize(m_projection->getBeams());
+	g_proj_y.resize(m_projection->getBeams());
+	g_proj_z.resize(m_projection->getBeams());
+	g_valid.resize(m_projection->getBeams());
+
+	KANAVI_LOG_INFO("[NODE] projection kernel : %s\n", m_projection->getKernelName());
+}
+
+void kanavi_node::length2PointCloud(const kanaviDatagram &datagram)
+{
+	// generate Point Cloud
+	generatePointCloud(datagram, g_cloudmsg);
+}
+
+void kanavi_node::generatePointCloud(const kanaviDatagram &datagram, sensor_msgs::msg::PointCloud2 &msg)
+{
+	size_t points = 0;
+
+	switch (datagram.model)
 	{
 	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL; i++)
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
+		if (m_cloud->isOrganized())
 		{
-			v_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_RESOLUTION * i)));
-			v_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_RESOLUTION * i)));
+			// one full row per channel, missing channels are NaN rows
+			size_t beams = static_cast<size_t>(m_projection->getBeams());
+			for (int ch = 0; ch < m_projection->getChannels(); ch++)
+			{
+				generateChannelPointCloud(datagram, ch, *m_cloud, msg, ch * beams);
+			}
+			finishCloudMsg(msg, beams, m_projection->getChannels());
+			return;
 		}
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_DATA_CNT; i++)
+
+		for (int ch = 0; ch < static_cast<int>(datagram.len_buf.size()); ch++)
 		{
-			h_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION * i)));
-			h_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION * i)));
+			points += generateChannelPointCloud(datagram, ch, *m_cloud, msg, points);
 		}
 		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL; i++)
+	default:
+		KANAVI_LOG_ERROR_THROTTLE(1000, "[NODE] Unknown model type: %d\n", datagram.model);
+		break;
+	}
+
+	finishCloudMsg(msg, points);
+}
+
+size_t kanavi_node::projectChannel(const kanaviDatagram &datagram, int ch)
+{
+	if (ch < 0 || ch >= m_projection->getChannels() || ch >= static_cast<int>(datagram.len_buf.size()))
+	{
+		return 0;
+	}
+	if (m_crop && !m_crop->isChannelEnabled(ch))
+	{
+		return 0;
+	}
+
+	const std::vector<float> &len_ = datagram.len_buf[ch];
+	size_t cnt = std::min(len_.size(), static_cast<size_t>(m_projection->getBeams()));
+	if (cnt == 0)
+	{
+		return 0;
+	}
+
+	// no return (0 m) and cropped beams are dropped, NaN when the beam has to keep its slot
+	if (m_crop)
+	{
+		m_crop->mask(len_.data(), ch, static_cast<int>(cnt), g_valid.data());
+	}
+	else
+	{
+		for (size_t i = 0; i < cnt; i++)
 		{
-			v_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION * i)));
-			v_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION * i)));
+			g_valid[i] = (len_[i] > 0) ? 1 : 0;
 		}
+	}
+
+	// whole row at once through the SIMD kernel
+	m_projection->project(len_.data(), ch, static_cast<int>(cnt), g_proj_x.data(), g_proj_y.data(), g_proj_z.data());
+
+	return cnt;
+}
+
+size_t kanavi_node::generateChannelPointCloud(const kanaviDatagram &datagram, int ch, const kanavi_cloud &layout, sensor_msgs::msg::PointCloud2 &msg, size_t offset)
+{
+	if (ch < 0 || ch >= m_projection->getChannels())
+	{
+		return 0;
+	}
+
+	size_t beams = static_cast<size_t>(m_projection->getBeams());
+	size_t cnt = projectChannel(datagram, ch);
+
+	// organized rows always span every beam
+	size_t row = layout.isOrganized() ? beams : cnt;
+	if (row == 0)
+	{
+		return 0;
+	}
+
+	// only grows on the first frame, the buffer is reused afterwards
+	size_t step = layout.getPointStep();
+	if (msg.data.size() < (offset + row) * step)
+	{
+		msg.data.resize((offset + row) * step);
+	}
+
+	size_t written = 0;
+	if (cnt > 0)
+	{
+		written = layout.write(&msg.data[offset * step], g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(),
+							   g_valid.data(), ch, static_cast<int>(cnt), *m_palette);
+	}
+
+	// organized rows keep every slot
+	if (layout.isOrganized() && written < row)
+	{
+		layout.writeInvalid(&msg.data[(offset + written) * step], ch, static_cast<int>(written), static_cast<int>(row - written));
+		written = row;
+	}
+
+	return written;
+}
+
+std::unique_ptr<kanavi_cloud> kanavi_node::createLayout(const std::string &layout)
+{
+	try
+	{
+		return std::make_unique<kanavi_cloud>(layout, checked_organized_);
+	}
+	catch (const std::exception &e)
+	{
+		printf("[NODE] %s, fall back to %s\n", e.what(), KANAVI::CLOUD::LAYOUT_XYZRGB.c_str());
+		return std::make_unique<kanavi_cloud>(KANAVI::CLOUD::LAYOUT_XYZRGB, checked_organized_);
+	}
+}
+
+void kanavi_node::initCloudMsg(sensor_msgs::msg::PointCloud2 &msg, const kanavi_cloud &layout, size_t points)
+{
+	msg.fields.clear();
+	for (const KANAVI::CLOUD::field &f : layout.getFields())
+	{
+		sensor_msgs::msg::PointField field;
+		field.name = f.name;
+		field.offset = f.offset;
+		field.datatype = f.datatype;
+		field.count = f.count;
+		msg.fields.push_back(field);
+	}
+
+	msg.header.set__frame_id(fixedName_);	// rviz의 fixed frame을 따라가야함
+	msg.is_bigendian = false;
+	msg.is_dense = !layout.isOrganized();	// organized clouds carry NaN points
+	msg.point_step = layout.getPointStep();
+	msg.data.reserve(points * msg.point_step);
+}
+
+void kanavi_node::finishCloudMsg(sensor_msgs::msg::PointCloud2 &msg, size_t width, size_t height)
+{
+	msg.height = static_cast<uint32_t>(height);
+	msg.width = static_cast<uint32_t>(width);
+	msg.row_step = msg.width * msg.point_step;
+	msg.data.resize(static_cast<size_t>(msg.row_step) * msg.height);	// no reallocation, capacity is kept
+}
+
+void kanavi_node::publish_pointcloud(const rclcpp::Time &stamp)
+{
+	g_cloudmsg.header.set__stamp(stamp);
+
+	publishCloud(publisher_, g_cloudmsg);
+}
+
+void kanavi_node::publishCloud(const rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr &publisher, sensor_msgs::msg::PointCloud2 &msg)
+{
+	if (!intra_process_)
+	{
+		publisher->publish(msg);
+		return;
+	}
+
+	// the buffer goes to the subscribers, the next frame starts on a fresh one of the same capacity
+	size_t capacity = msg.data.capacity();
+	auto owned = std::make_unique<sensor_msgs::msg::PointCloud2>(std::move(msg));
+
+	msg.header = owned->header;
+	msg.fields = owned->fields;
+	msg.height = owned->height;
+	msg.width = owned->width;
+	msg.point_step = owned->point_step;
+	msg.row_step = owned->row_step;
+	msg.is_dense = owned->is_dense;
+	msg.is_bigendian = owned->is_bigendian;
+	msg.data.clear();
+	msg.data.reserve(capacity);
+
+	publisher->publish(std::move(owned));
+}
+
+void kanavi_node::publishChannel(int ch, const rclcpp::Time &stamp)
+{
+	if (ch < 0 || ch >= static_cast<int>(channel_publishers_.size()))
+	{
+		return;
+	}
+
+	size_t points = generateChannelPointCloud(m_process->getDatagram(), ch, *m_channelcloud, g_channelmsg, 0);
+	finishCloudMsg(g_channelmsg, points);
+
+	g_channelmsg.header.set__stamp(stamp);	// arrival time of this channel, not of the frame
+
+	publishCloud(channel_publishers_[ch], g_channelmsg);
+}
+
+void kanavi_node::publishRangeImage(const rclcpp::Time &stamp)
+{
+	m_image->write(g_imagemsg.data.data(), m_process->getDatagram().len_buf);
+
+	g_imagemsg.header.set__stamp(stamp);
+	image_publisher_->publish(g_imagemsg);
+}
+
+void kanavi_node::publishBeamAngles()
+{
+	// data = elevation[channels] followed by azimuth[beams], [deg]
+	std_msgs::msg::Float32MultiArray msg_;
+	msg_.layout.dim.resize(2);
+	msg_.layout.dim[0].label = "elevation";
+	msg_.layout.dim[0].size = m_projection->getChannels();
+	msg_.layout.dim[0].stride = m_projection->getChannels();
+	msg_.layout.dim[1].label = "azimuth";
+	msg_.layout.dim[1].size = m_projection->getBeams();
+	msg_.layout.dim[1].stride = m_projection->getBeams();
+	msg_.layout.data_offset = 0;
+
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
+	{
+		msg_.data.push_back(m_projection->getElevation(ch));
+	}
+	for (int i = 0; i < m_projection->getBeams(); i++)
+	{
+		msg_.data.push_back(m_projection->getAzimuth(i));
+	}
+
+	angle_publisher_->publish(msg_);
+}
+
+void kanavi_node::publishScan(const rclcpp::Time &stamp)
+{
+	const kanaviDatagram &datagram = m_process->getDatagram();
+
+	// measured frame period
+	int64_t now_ns = stamp.nanoseconds();
+	g_scanmsg.scan_time = (g_laststamp == 0) ? 0 : static_cast<float>((now_ns - g_laststamp) * 1e-9);
+	g_laststamp = now_ns;
+	g_scanmsg.header.set__stamp(stamp);
 
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_DATA_CNT; i++)
+	for (size_t ch = 0; ch < scan_publishers_.size(); ch++)
+	{
+		if (ch < datagram.len_buf.size())
 		{
-			h_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION * i)));
-			h_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION * i)));
+			m_scan->write(g_scanmsg.ranges.data(), datagram.len_buf[ch].data(), static_cast<int>(datagram.len_buf[ch].size()));
 		}
-		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_DATA_CNT; i++)
+		else
 		{
-			h_sin.push_back(sin(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION * i)));
-			h_cos.push_back(cos(DEG2RAD(KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION * i)));
+			m_scan->write(g_scanmsg.ranges.data(), nullptr, 0);
 		}
-		break;
+		scan_publishers_[ch]->publish(g_scanmsg);
 	}
 }
 
-void kanavi_node::length2PointCloud(kanaviDatagram datagram)
+void kanavi_node::updateCalibration()
 {
+	if (!m_calibration)
+	{
+		return;
+	}
 
-	// generate Point Cloud
-	generatePointCloud(datagram, *g_pointcloud);
+	int64_t now = KANAVI::LOG::nowMs();
+	if (now - g_calibcheck < KANAVI::CALIBRATION::RELOAD_PERIOD_MS)
+	{
+		return;
+	}
+	g_calibcheck = now;
+
+	// a broken file keeps the loaded sections
+	bool reloaded = m_calibration->isModified() && m_calibration->load();
+
+	const std::string &ip = m_udp->getSenderIP();
+	if (!reloaded && ip == calibIP_)
+	{
+		return;
+	}
+	calibIP_ = ip;
+
+	KANAVI::CALIBRATION::intrinsic calib;
+	if (!m_calibration->find(ip, calib))
+	{
+		KANAVI_LOG_WARN("[NODE] no calibration of %s, specification is used\n", ip);
+	}
+
+	try
+	{
+		m_projection = std::make_unique<kanavi_projection>(m_projection->getModel(), m_projection->getBaseAngle(), calib, m_projection->getPose());
+	}
+	catch (const std::exception &e)
+	{
+		KANAVI_LOG_WARN("[NODE] %s, calibration not applied\n", e.what());
+		return;
+	}
+	if (m_crop)
+	{
+		m_crop = std::make_unique<kanavi_crop>(crop_, *m_projection);
+	}
+	if (m_zone)
+	{
+		m_zone->compile(*m_projection);
+	}
+	KANAVI_LOG_INFO("[NODE] calibration of %s applied\n", ip);
+
+	// range image consumers follow the calibrated angles
+	if (m_image)
+	{
+		publishBeamAngles();
+	}
+	if (m_scan)
+	{
+		updateScanAngles();
+	}
+}
 
-	// printf("CHECK point CLoud NUM : %d\n", g_pointcloud->size());
+void kanavi_node::updateScanAngles()
+{
+	m_scan = std::make_unique<kanavi_scan>(*m_projection);
+
+	g_scanmsg.angle_min = m_scan->getAngleMin();
+	g_scanmsg.angle_max = m_scan->getAngleMax();
+	g_scanmsg.angle_increment = m_scan->getAngleIncrement();
+
+	if (m_scan->getMaxDeviation() > KANAVI::SCAN::MAX_DEVIATION)
+	{
+		KANAVI_LOG_WARN("[NODE] per-beam azimuth offsets up to %.3f deg are not shown in the uniform LaserScan angles\n",
+						m_scan->getMaxDeviation());
+	}
 }
 
-void kanavi_node::generatePointCloud(const kanaviDatagram &datagram, PointCloudT &cloud_)
+void kanavi_node::lookupPose()
 {
-	switch (datagram.model)
+	// static mounting : looked up once, the listener is dropped afterwards
+	tf2_ros::Buffer buffer(this->get_clock());
+	tf2_ros::TransformListener listener(buffer);
+
+	try
 	{
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
-		for (int ch = 0; ch < KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL; ch++)
+		geometry_msgs::msg::TransformStamped tf = buffer.lookupTransform(fixedName_, poseFrame_, tf2::TimePointZero,
+																		 tf2::durationFromSec(KANAVI::CALIBRATION::TF_TIMEOUT));
+
+		tf2::Quaternion q(tf.transform.rotation.x, tf.transform.rotation.y, tf.transform.rotation.z, tf.transform.rotation.w);
+		double roll, pitch, yaw;
+		tf2::Matrix3x3(q).getRPY(roll, pitch, yaw);
+
+		pose_.x = static_cast<float>(tf.transform.translation.x);
+		pose_.y = static_cast<float>(tf.transform.translation.y);
+		pose_.z = static_cast<float>(tf.transform.translation.z);
+		pose_.roll = static_cast<float>(roll * 180.0 / M_PI);
+		pose_.pitch = static_cast<float>(pitch * 180.0 / M_PI);
+		pose_.yaw = static_cast<float>(yaw * 180.0 / M_PI);
+	}
+	catch (const tf2::TransformException &e)
+	{
+		printf("[NODE] %s, %s is used\n", e.what(), KANAVI::ROS::PARAMETER_POSE.c_str());
+	}
+}
+
+void kanavi_node::publishVoxel(const rclcpp::Time &stamp)
+{
+	const kanaviDatagram &datagram = m_process->getDatagram();
+
+	m_voxel->clear();
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
+	{
+		size_t cnt = projectChannel(datagram, ch);
+		if (cnt > 0)
 		{
-			for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_DATA_CNT; i++)
-			{
-				cloud_.push_back(length2point(datagram.len_buf[ch][i], v_sin[ch], v_cos[ch], h_sin[i], h_cos[i]));
-			}
+			m_voxel->insert(g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(), g_valid.data(),
+							static_cast<int>(cnt));
 		}
-		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
-		for (int ch = 0; ch < KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL; ch++)
+	}
+	m_voxel->finish();
+
+	// capacity was reserved for a full frame
+	size_t points = m_voxel->size();
+	g_voxelmsg.data.resize(points * m_voxelcloud->getPointStep());
+
+	size_t written = m_voxelcloud->write(g_voxelmsg.data.data(), m_voxel->getX(), m_voxel->getY(), m_voxel->getZ(),
+										 m_voxel->getRange(), nullptr, 0, static_cast<int>(points), *m_palette);
+	finishCloudMsg(g_voxelmsg, written);
+
+	g_voxelmsg.header.set__stamp(stamp);
+	publishCloud(voxel_publisher_, g_voxelmsg);
+}
+
+void kanavi_node::publishForeground(const rclcpp::Time &stamp)
+{
+	const kanaviDatagram &datagram = m_process->getDatagram();
+
+	m_background->update(datagram.len_buf);
+	bool active = m_background->isActive();
+
+	g_activitymsg.data = active;
+	activity_publisher_->publish(g_activitymsg);
+
+	// an empty scene costs the flag only, one empty cloud clears the last foreground
+	if (!active && !g_foregroundsent)
+	{
+		return;
+	}
+
+	size_t points = 0;
+	if (active && foreground_publisher_->get_subscription_count() + foreground_publisher_->get_intra_process_subscription_count() > 0)
+	{
+		size_t step = m_foregroundcloud->getPointStep();
+		g_foregroundmsg.data.resize(static_cast<size_t>(m_projection->getChannels()) * m_projection->getBeams() * step);
+
+		for (int ch = 0; ch < m_projection->getChannels(); ch++)
 		{
-			for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_DATA_CNT; i++)
+			size_t cnt = projectChannel(datagram, ch);
+			if (cnt == 0 || m_background->mask(ch, static_cast<int>(cnt), g_valid.data()) == 0)
 			{
-				cloud_.push_back(length2point(datagram.len_buf[ch][i], v_sin[ch], v_cos[ch], h_sin[i], h_cos[i]));
+				continue;
 			}
+			points += m_foregroundcloud->write(&g_foregroundmsg.data[points * step], g_proj_x.data(), g_proj_y.data(), g_proj_z.data(),
+											   datagram.len_buf[ch].data(), g_valid.data(), ch, static_cast<int>(cnt), *m_palette);
 		}
-		break;
-	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
+	}
+	finishCloudMsg(g_foregroundmsg, points);
 
-		for (int i = 0; i < KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_DATA_CNT; i++)
-		{
-			cloud_.push_back(length2point(datagram.len_buf[0][i], 0, 1, h_sin[i], h_cos[i]));
-		}
+	g_foregroundmsg.header.set__stamp(stamp);
+	publishCloud(foreground_publisher_, g_foregroundmsg);
+	g_foregroundsent = (points > 0);
+}
 
-		break;
+void kanavi_node::publishDelta()
+{
+	// the reference is lost for whoever joins later, restart from a keyframe
+	if (delta_publisher_->get_subscription_count() + delta_publisher_->get_intra_process_subscription_count() == 0)
+	{
+		m_delta->requestKeyframe();
+		return;
 	}
+
+	const std::vector<uint8_t> &frame = m_delta->encode(m_process->getDatagram().len_buf);
+	g_deltamsg.data.assign(frame.begin(), frame.end());	// capacity is kept
+	delta_publisher_->publish(g_deltamsg);
 }
 
-PointT kanavi_node::length2point(float len, float v_sin, float v_cos, float h_sin, float h_cos)
+void kanavi_node::publishZones(bool all)
 {
-	pcl::PointXYZRGB p_;
-
-	p_.x = len * v_cos * h_cos;
-	p_.y = len * v_cos * h_sin;
-	p_.z = len * v_sin;
+	for (size_t i = 0; i < m_zone->size(); i++)
+	{
+		if (all || m_zone->isChanged(i))
+		{
+			g_zonemsg.data = m_zone->isOccupied(i);
+			zone_publishers_[i]->publish(g_zonemsg);
+		}
+	}
+}
 
-	float r, g, b;
-	HSV2RGB(&r, &g, &b, len * 20, 1.0, 1.0); // convert hsv to rgb
-	p_.r = r * 255;
-	p_.g = g * 255;
-	p_.b = b * 255;
+void kanavi_node::publishStatus()
+{
+	const kanaviStatus &status = m_process->getStatus();
 
-	return p_;
+	// [0] detection, [1] flags, [2 ~] area configuration
+	g_statusmsg.data[0] = status.detection;
+	g_statusmsg.data[1] = status.flags;
+	std::copy(status.area_config, status.area_config + KANAVI::STATUS::AREA_CONFIG_SIZE, g_statusmsg.data.begin() + 2);
+	status_publisher_->publish(g_statusmsg);
 }
 
-void kanavi_node::HSV2RGB(float *fR, float *fG, float *fB, float fH, float fS, float fV)
+void kanavi_node::publishClusters()
 {
-	float fC = fV * fS;
-	float fHPrime = fmod(fH / 60.0, 6);
-	float fX = fC * (1 - fabs(fmod(fHPrime, 2) - 1));
-	float fM = fV - fC;
+	const kanaviDatagram &datagram = m_process->getDatagram();
 
-	if (0 <= fHPrime && fHPrime < 1)
+	// rings in channel order, the projected rows are consumed right away
+	m_cluster->clear();
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
 	{
-		*fR = fC;
-		*fG = fX;
-		*fB = 0;
+		size_t cnt = projectChannel(datagram, ch);
+		if (cnt > 0)
+		{
+			m_cluster->insert(ch, g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(), g_valid.data(),
+							  static_cast<int>(cnt));
+		}
 	}
+	m_cluster->finish();
 
-	else if (0 <= fHPrime && fHPrime < 2)
-	{
-		*fR = fX;
-		*fG = fC;
-		*fB = 0;
-	}
-	else if (0 <= fHPrime && fHPrime < 3)
+	// capacity was reserved for a full frame
+	const std::vector<KANAVI::CLUSTER::cluster> &clusters = m_cluster->getClusters();
+	g_clustermsg.data.resize(clusters.size() * KANAVI::CLUSTER::FIELDS);
+
+	float *out = g_clustermsg.data.data();
+	for (const KANAVI::CLUSTER::cluster &c : clusters)
 	{
-		*fR = 0;
-		*fG = fC;
-		*fB = fX;
+		std::copy(c.centroid, c.centroid + 3, out);
+		std::copy(c.min, c.min + 3, out + 3);
+		std::copy(c.max, c.max + 3, out + 6);
+		out[9] = static_cast<float>(c.count);
+		out += KANAVI::CLUSTER::FIELDS;
 	}
-	else if (0 <= fHPrime && fHPrime < 4)
+	g_clustermsg.layout.dim[0].size = static_cast<uint32_t>(clusters.size());
+	g_clustermsg.layout.dim[0].stride = static_cast<uint32_t>(clusters.size() * KANAVI::CLUSTER::FIELDS);
+
+	cluster_publisher_->publish(g_clustermsg);
+}
+
+void kanavi_node::publishAccumulated(const rclcpp::Time &stamp)
+{
+	std::lock_guard<std::mutex> lock(accumulate_mutex_);
+
+	// compensation needs a pose, frames before the first odometry are not kept
+	if (!odomTopic_.empty() && !m_accumulate->hasPose())
 	{
-		*fR = 0;
-		*fG = fX;
-		*fB = fC;
+		KANAVI_LOG_WARN_THROTTLE(1000, "[NODE] Waiting for odometry on %s\n", odomTopic_.c_str());
+		return;
 	}
-	else if (0 <= fHPrime && fHPrime < 5)
+
+	const kanaviDatagram &datagram = m_process->getDatagram();
+	size_t beams = static_cast<size_t>(m_projection->getBeams());
+	size_t step = m_acccloud->getPointStep();
+	uint8_t *slot = &g_accmsg.data[m_accumulate->begin() * step];
+
+	// the oldest row is overwritten in place, beams without a point become NaN
+	for (int ch = 0; ch < m_projection->getChannels(); ch++)
 	{
-		*fR = fX;
-		*fG = 0;
-		*fB = fC;
+		uint8_t *row = slot + ch * beams * step;
+		size_t cnt = projectChannel(datagram, ch);
+		if (cnt > 0)
+		{
+			m_accumulate->transform(g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), static_cast<int>(cnt));
+			m_acccloud->write(row, g_proj_x.data(), g_proj_y.data(), g_proj_z.data(), datagram.len_buf[ch].data(), g_valid.data(),
+							  ch, static_cast<int>(cnt), *m_palette);
+		}
+		if (cnt < beams)
+		{
+			m_acccloud->writeInvalid(row + cnt * step, ch, static_cast<int>(cnt), static_cast<int>(beams - cnt));
+		}
 	}
-	else if (0 <= fHPrime && fHPrime < 6)
+
+	// the window is published as it lies in the ring, rows are not reordered
+	if (m_accumulate->end() && accumulate_publisher_->get_subscription_count() + accumulate_publisher_->get_intra_process_subscription_count() > 0)
 	{
-		*fR = fC;
-		*fG = 0;
-		*fB = fX;
+		g_accmsg.header.set__stamp(stamp);
+		accumulate_publisher_->publish(g_accmsg);
 	}
-	else
+}
+
+void kanavi_node::odometryCallback(const nav_msgs::msg::Odometry::SharedPtr msg)
+{
+	std::lock_guard<std::mutex> lock(accumulate_mutex_);
+
+	m_accumulate->setPose(msg->pose.pose.position.x, msg->pose.pose.position.y, msg->pose.pose.position.z,
+						  msg->pose.pose.orientation.x, msg->pose.pose.orientation.y, msg->pose.pose.orientation.z, msg->pose.pose.orientation.w);
+
+	// points are written in the odometry frame from now on
+	g_accmsg.header.frame_id = msg->header.frame_id;
+}
+
+void kanavi_node::publishFrame(const rclcpp::Time &stamp)
+{
+#if KANAVI_TYPE_ADAPTER
+	if (frame_publisher_->get_subscription_count() + frame_publisher_->get_intra_process_subscription_count() == 0)
 	{
-		*fR = 0;
-		*fG = 0;
-		*fB = 0;
+		return;
 	}
+
+	int channels = m_projection->getChannels();
+	int beams = m_projection->getBeams();
+
+	auto frame = std::make_unique<kanaviFrame>();
+	frame->header.stamp = stamp;
+	frame->header.frame_id = fixedName_;
+	frame->channels = channels;
+	frame->beams = beams;
+	frame->ranges.resize(static_cast<size_t>(channels) * beams);
+	frame->projection = m_projection;
+	frame->layout = m_cloud;
+	frame->palette = m_palette;
+
+	// crop is applied here, the cloud written later only drops the zeros
+	writeRanges(frame->ranges.data());
+
+	// intra-process subscribers of kanaviFrame take the frame as is
+	frame_publisher_->publish(std::move(frame));
+#else
+	(void)stamp;
+#endif
 }
 
-void kanavi_node::rotateAxisZ(PointCloudT::Ptr cloud, float angle)
+void kanavi_node::writeRanges(float *dst)
 {
-	float rad = pcl::deg2rad(angle);
-	Eigen::Matrix4f m_ = Eigen::Matrix4f::Identity();
-	m_(0, 0) = cos(rad);
-	m_(0, 1) = -sin(rad);
-	m_(1, 0) = sin(rad);
-	m_(1, 1) = cos(rad);
+	const kanaviDatagram &datagram = m_process->getDatagram();
+	int channels = m_projection->getChannels();
+	int beams = m_projection->getBeams();
+
+	std::fill(dst, dst + static_cast<size_t>(channels) * beams, 0.0f);
+	for (int ch = 0; ch < channels && ch < static_cast<int>(datagram.len_buf.size()); ch++)
+	{
+		if (m_crop && !m_crop->isChannelEnabled(ch))
+		{
+			continue;
+		}
 
-	pcl::transformPointCloud(*cloud, *cloud, m_);
+		const std::vector<float> &len_ = datagram.len_buf[ch];
+		int cnt = std::min(static_cast<int>(len_.size()), beams);
+		float *row = dst + static_cast<size_t>(ch) * beams;
+		if (m_crop)
+		{
+			m_crop->mask(len_.data(), ch, cnt, g_valid.data());
+			for (int i = 0; i < cnt; i++)
+			{
+				row[i] = g_valid[i] ? len_[i] : 0.0f;
+			}
+		}
+		else
+		{
+			std::copy(len_.begin(), len_.begin() + cnt, row);
+		}
+	}
 }
 
-void kanavi_node::publish_pointcloud(PointCloudT::Ptr cloud_)
+void kanavi_node::publishRanges(const rclcpp::Time &stamp)
 {
-	sensor_msgs::msg::PointCloud2 msg_;
-	pcl::toROSMsg(*cloud_, msg_);
+	if (ranges_publisher_->get_subscription_count() + ranges_publisher_->get_intra_process_subscription_count() == 0)
+	{
+		return;
+	}
 
-	msg_.header.set__frame_id(fixedName_);	// rviz의 fixed frame을 따라가야함
-	msg_.header.set__stamp(this->get_clock()->now());
+	// written straight into middleware memory, published without serialization
+	if (ranges_publisher_->can_loan_messages())
+	{
+		auto loaned = ranges_publisher_->borrow_loaned_message();
+		kanavi_vl::msg::RangeFrame &msg = loaned.get();
+		msg.stamp = stamp;
+		msg.model = static_cast<uint8_t>(m_projection->getModel());
+		msg.channels = static_cast<uint16_t>(m_projection->getChannels());
+		msg.beams = static_cast<uint16_t>(m_projection->getBeams());
+		writeRanges(msg.ranges.data());
+		ranges_publisher_->publish(std::move(loaned));
+		return;
+	}
 
-	publisher_->publish(msg_);
-}
\ No newline at end of file
+	g_rangesmsg.stamp = stamp;
+	g_rangesmsg.model = static_cast<uint8_t>(m_projection->getModel());
+	g_rangesmsg.channels = static_cast<uint16_t>(m_projection->getChannels());
+	g_rangesmsg.beams = static_cast<uint16_t>(m_projection->getBeams());
+	writeRanges(g_rangesmsg.ranges.data());
+	ranges_publisher_->publish(g_rangesmsg);
+}
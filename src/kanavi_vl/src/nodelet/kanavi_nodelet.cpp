@@ -0,0 +1,67 @@
+#if defined(ROS1)
+
+#include "ros1/kanavi_nodelet.h"
+
+#include <pluginlib/class_list_macros.h>
+
+#include <vector>
+
+kanavi_nodelet::kanavi_nodelet()
+{
+}
+
+kanavi_nodelet::~kanavi_nodelet()
+{
+	// the UDP receive times out, run() sees the flag within one timeout
+	if (node_)
+	{
+		node_->stop();
+	}
+	if (thread_.joinable())
+	{
+		thread_.join();
+	}
+}
+
+void kanavi_nodelet::onInit()
+{
+	std::string model;
+	getPrivateNodeHandle().param<std::string>("model", model, "r270");
+
+	// load arguments = options of the standalone nodes
+	std::vector<std::string> args = {getName()};
+	for (const std::string &arg : getMyArgv())
+	{
+		// help only prints the options and does not start the node
+		if (arg == KANAVI::ROS::PARAMETER_Help)
+		{
+			NODELET_WARN("%s is ignored in a nodelet", arg.c_str());
+			continue;
+		}
+		args.push_back(arg);
+	}
+
+	std::vector<char *> argv;
+	for (std::string &arg : args)
+	{
+		argv.push_back(&arg[0]);
+	}
+	int argc = static_cast<int>(argv.size());
+	argv.push_back(nullptr);
+
+	try
+	{
+		node_ = std::make_unique<kanavi_node>(getNodeHandle(), &queue_, model, argc, argv.data());
+	}
+	catch (const std::exception &e)
+	{
+		// the manager and its other nodelets keep running
+		NODELET_ERROR("%s, nodelet not started", e.what());
+		return;
+	}
+	thread_ = std::thread(&kanavi_node::run, node_.get());
+}
+
+PLUGINLIB_EXPORT_CLASS(kanavi_nodelet, nodelet::Nodelet)
+
+#endif
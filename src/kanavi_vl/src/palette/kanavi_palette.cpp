@@ -0,0 +1,101 @@
+#include "kanavi_palette.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	inline uint32_t pack(float r, float g, float b)
+	{
+		uint32_t r_ = static_cast<uint32_t>(r * 255);
+		uint32_t g_ = static_cast<uint32_t>(g * 255);
+		uint32_t b_ = static_cast<uint32_t>(b * 255);
+		return (r_ << 16) | (g_ << 8) | b_;
+	}
+
+	// same mapping the node used per point (S = V = 1)
+	uint32_t hsv(float fH)
+	{
+		float fC = 1.0;
+		float fHPrime = fmod(fH / 60.0, 6);
+		float fX = fC * (1 - fabs(fmod(fHPrime, 2) - 1));
+
+		if (0 <= fHPrime && fHPrime < 1)
+		{
+			return pack(fC, fX, 0);
+		}
+		else if (1 <= fHPrime && fHPrime < 2)
+		{
+			return pack(fX, fC, 0);
+		}
+		else if (2 <= fHPrime && fHPrime < 3)
+		{
+			return pack(0, fC, fX);
+		}
+		else if (3 <= fHPrime && fHPrime < 4)
+		{
+			return pack(0, fX, fC);
+		}
+		else if (4 <= fHPrime && fHPrime < 5)
+		{
+			return pack(fX, 0, fC);
+		}
+		else if (5 <= fHPrime && fHPrime < 6)
+		{
+			return pack(fC, 0, fX);
+		}
+		return 0;
+	}
+}
+
+/**
+ * @brief Construct a new kanavi palette::kanavi palette object
+ *
+ * @param name palette name ref include/kanavi_palette.h
+ * @param range distance mapped onto one palette span [m]
+ */
+kanavi_palette::kanavi_palette(const std::string &name, float range)
+	: name_(name), range_(range), enabled_(name != KANAVI::PALETTE::NONE)
+{
+	if (name_ != KANAVI::PALETTE::HSV && name_ != KANAVI::PALETTE::GRAY && name_ != KANAVI::PALETTE::NONE)
+	{
+		throw std::runtime_error("Invalid palette : " + name_);
+	}
+	if (!(range_ > 0))
+	{
+		throw std::runtime_error("Invalid color range");
+	}
+
+	build();
+}
+
+kanavi_palette::~kanavi_palette()
+{
+}
+
+void kanavi_palette::build()
+{
+	size_t total = static_cast<size_t>(KANAVI::PALETTE::MAX_RANGE * KANAVI::PALETTE::RESOLUTION);
+	table_.assign(total, 0);
+
+	if (!enabled_)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < total; i++)
+	{
+		float len = static_cast<float>(i) / KANAVI::PALETTE::RESOLUTION;
+		float t = len / range_;		// 1.0 = one palette span
+
+		if (name_ == KANAVI::PALETTE::HSV)
+		{
+			table_[i] = hsv(t * 360);
+		}
+		else
+		{
+			float v = (t > 1) ? 1 : t;
+			table_[i] = pack(v, v, v);
+		}
+	}
+}
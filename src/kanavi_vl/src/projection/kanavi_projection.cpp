@@ -0,0 +1,298 @@
+#include "kanavi_projection.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KANAVI_PROJECTION_X86
+#endif
+
+namespace
+{
+	inline double deg2rad(double deg)
+	{
+		return deg * M_PI / 180.0;
+	}
+
+	// empty = default, one value = every index, otherwise one value per index
+	float pick(const std::vector<float> &values, int idx, float def)
+	{
+		if (values.empty())
+		{
+			return def;
+		}
+		return (values.size() == 1) ? values[0] : values[idx];
+	}
+
+	void checkSize(const std::vector<float> &values, int expected, const char *key)
+	{
+		if (values.size() > 1 && static_cast<int>(values.size()) != expected)
+		{
+			throw std::runtime_error(std::string("Invalid calibration size of ") + key +
+									 " (" + std::to_string(values.size()) + " != " + std::to_string(expected) + ")");
+		}
+	}
+
+	//SECTION - projection kernels
+	void projectScalar(const float *len, const float *dx, const float *dy, const float *dz,
+					   int count, float *x, float *y, float *z)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float r = len[i];
+			x[i] = r * dx[i];
+			y[i] = r * dy[i];
+			z[i] = r * dz[i];
+		}
+	}
+
+#ifdef KANAVI_PROJECTION_X86
+	void projectSSE(const float *len, const float *dx, const float *dy, const float *dz,
+					int count, float *x, float *y, float *z)
+	{
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 r = _mm_loadu_ps(len + i);
+			_mm_storeu_ps(x + i, _mm_mul_ps(r, _mm_loadu_ps(dx + i)));
+			_mm_storeu_ps(y + i, _mm_mul_ps(r, _mm_loadu_ps(dy + i)));
+			_mm_storeu_ps(z + i, _mm_mul_ps(r, _mm_loadu_ps(dz + i)));
+		}
+		projectScalar(len + i, dx + i, dy + i, dz + i, count - i, x + i, y + i, z + i);
+	}
+
+	__attribute__((target("avx2")))
+	void projectAVX2(const float *len, const float *dx, const float *dy, const float *dz,
+					 int count, float *x, float *y, float *z)
+	{
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 r = _mm256_loadu_ps(len + i);
+			_mm256_storeu_ps(x + i, _mm256_mul_ps(r, _mm256_loadu_ps(dx + i)));
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(r, _mm256_loadu_ps(dy + i)));
+			_mm256_storeu_ps(z + i, _mm256_mul_ps(r, _mm256_loadu_ps(dz + i)));
+		}
+		projectSSE(len + i, dx + i, dy + i, dz + i, count - i, x + i, y + i, z + i);
+	}
+#endif
+
+	// range offset : r * d + o, no return (0 m) stays at the origin
+	void projectOffsetScalar(const float *len, const float *dx, const float *dy, const float *dz,
+							 const float *ox, const float *oy, const float *oz,
+							 int count, float *x, float *y, float *z)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float r = len[i];
+			bool hit = r > 0;
+			x[i] = hit ? r * dx[i] + ox[i] : 0;
+			y[i] = hit ? r * dy[i] + oy[i] : 0;
+			z[i] = hit ? r * dz[i] + oz[i] : 0;
+		}
+	}
+
+#ifdef KANAVI_PROJECTION_X86
+	void projectOffsetSSE(const float *len, const float *dx, const float *dy, const float *dz,
+						  const float *ox, const float *oy, const float *oz,
+						  int count, float *x, float *y, float *z)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 r = _mm_loadu_ps(len + i);
+			__m128 hit = _mm_cmpgt_ps(r, zero);
+			_mm_storeu_ps(x + i, _mm_and_ps(hit, _mm_add_ps(_mm_mul_ps(r, _mm_loadu_ps(dx + i)), _mm_loadu_ps(ox + i))));
+			_mm_storeu_ps(y + i, _mm_and_ps(hit, _mm_add_ps(_mm_mul_ps(r, _mm_loadu_ps(dy + i)), _mm_loadu_ps(oy + i))));
+			_mm_storeu_ps(z + i, _mm_and_ps(hit, _mm_add_ps(_mm_mul_ps(r, _mm_loadu_ps(dz + i)), _mm_loadu_ps(oz + i))));
+		}
+		projectOffsetScalar(len + i, dx + i, dy + i, dz + i, ox + i, oy + i, oz + i, count - i, x + i, y + i, z + i);
+	}
+
+	__attribute__((target("avx2,fma")))
+	void projectOffsetAVX2(const float *len, const float *dx, const float *dy, const float *dz,
+						   const float *ox, const float *oy, const float *oz,
+						   int count, float *x, float *y, float *z)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 r = _mm256_loadu_ps(len + i);
+			__m256 hit = _mm256_cmp_ps(r, zero, _CMP_GT_OQ);
+			_mm256_storeu_ps(x + i, _mm256_and_ps(hit, _mm256_fmadd_ps(r, _mm256_loadu_ps(dx + i), _mm256_loadu_ps(ox + i))));
+			_mm256_storeu_ps(y + i, _mm256_and_ps(hit, _mm256_fmadd_ps(r, _mm256_loadu_ps(dy + i), _mm256_loadu_ps(oy + i))));
+			_mm256_storeu_ps(z + i, _mm256_and_ps(hit, _mm256_fmadd_ps(r, _mm256_loadu_ps(dz + i), _mm256_loadu_ps(oz + i))));
+		}
+		projectOffsetSSE(len + i, dx + i, dy + i, dz + i, ox + i, oy + i, oz + i, count - i, x + i, y + i, z + i);
+	}
+#endif
+	//!SECTION
+}
+
+/**
+ * @brief Construct a new kanavi projection::kanavi projection object
+ *
+ * @param model LiDAR Model ref include/common.h
+ * @param base_angle rotation around Z [deg]
+ * @param calib intrinsic correction of the sensor
+ * @param pose mounting pose of the sensor in the output frame
+ */
+kanavi_projection::kanavi_projection(int model, float base_angle, const KANAVI::CALIBRATION::intrinsic &calib, const KANAVI::CALIBRATION::extrinsic &pose)
+	: kernel_(projectScalar), offset_kernel_(projectOffsetScalar), kernel_name_("scalar"), has_offset_(false), calib_(calib), pose_(pose), model_(model), channels_(0), beams_(0), v_resolution_(0), h_resolution_(0), base_angle_(base_angle)
+{
+	switch (model_)
+	{
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R2:
+		channels_ = KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_CHANNEL;
+		beams_ = KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_DATA_CNT;
+		v_resolution_ = KANAVI::COMMON::SPECIFICATION::R2::VERTICAL_RESOLUTION;
+		h_resolution_ = KANAVI::COMMON::SPECIFICATION::R2::HORIZONTAL_RESOLUTION;
+		break;
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R4:
+		channels_ = KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_CHANNEL;
+		beams_ = KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_DATA_CNT;
+		v_resolution_ = KANAVI::COMMON::SPECIFICATION::R4::VERTICAL_RESOLUTION;
+		h_resolution_ = KANAVI::COMMON::SPECIFICATION::R4::HORIZONTAL_RESOLUTION;
+		break;
+	case KANAVI::COMMON::PROTOCOL_VALUE::MODEL::R270:
+		// single channel on the horizontal plane
+		channels_ = KANAVI::COMMON::SPECIFICATION::R270::VERTICAL_CHANNEL;
+		beams_ = KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_DATA_CNT;
+		v_resolution_ = 0;
+		h_resolution_ = KANAVI::COMMON::SPECIFICATION::R270::HORIZONTAL_RESOLUTION;
+		break;
+	default:
+		throw std::runtime_error("Invalid model type");
+	}
+
+	checkSize(calib_.vertical, channels_, "vertical");
+	checkSize(calib_.azimuth_offset, beams_, "azimuth_offset");
+	checkSize(calib_.range_offset, channels_, "range_offset");
+	checkSize(calib_.range_scale, channels_, "range_scale");
+	if (calib_.vertical.size() == 1 && channels_ > 1)
+	{
+		throw std::runtime_error("Invalid calibration size of vertical (one value per channel)");
+	}
+
+	// runtime dispatch : pick the widest kernel this CPU supports
+#ifdef KANAVI_PROJECTION_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		kernel_ = projectAVX2;
+		offset_kernel_ = __builtin_cpu_supports("fma") ? projectOffsetAVX2 : projectOffsetSSE;
+		kernel_name_ = "avx2";
+	}
+	else if (__builtin_cpu_supports("sse2"))
+	{
+		kernel_ = projectSSE;
+		offset_kernel_ = projectOffsetSSE;
+		kernel_name_ = "sse";
+	}
+#endif
+
+	build();
+}
+
+kanavi_projection::~kanavi_projection()
+{
+}
+
+void kanavi_projection::build()
+{
+	size_t total = static_cast<size_t>(channels_) * beams_;
+	dx_.resize(total);
+	dy_.resize(total);
+	dz_.resize(total);
+	elevation_.resize(channels_);
+	azimuth_.resize(beams_);
+
+	// mounting rotation, R = Rz(yaw) * Ry(pitch) * Rx(roll)
+	double cr = cos(deg2rad(pose_.roll)), sr = sin(deg2rad(pose_.roll));
+	double cp = cos(deg2rad(pose_.pitch)), sp = sin(deg2rad(pose_.pitch));
+	double cy = cos(deg2rad(pose_.yaw)), sy = sin(deg2rad(pose_.yaw));
+	const double rot[3][3] = {
+		{cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr},
+		{sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr},
+		{-sp, cp * sr, cp * cr}};
+
+	has_offset_ = pose_.hasTranslation();
+	for (int ch = 0; ch < channels_; ch++)
+	{
+		has_offset_ = has_offset_ || pick(calib_.range_offset, ch, 0) != 0;
+	}
+	ox_.assign(has_offset_ ? total : 0, 0);
+	oy_.assign(has_offset_ ? total : 0, 0);
+	oz_.assign(has_offset_ ? total : 0, 0);
+
+	for (int i = 0; i < beams_; i++)
+	{
+		azimuth_[i] = static_cast<float>(h_resolution_ * i + base_angle_ + pick(calib_.azimuth_offset, i, 0));
+	}
+
+	for (int ch = 0; ch < channels_; ch++)
+	{
+		// calibrated elevation replaces the nominal one
+		elevation_[ch] = pick(calib_.vertical, ch, static_cast<float>(v_resolution_ * ch));
+
+		double v_rad = deg2rad(elevation_[ch]);
+		double v_sin = sin(v_rad);
+		double v_cos = cos(v_rad);
+
+		// R * (r * scale + offset) * u + t = r * (scale * R * u) + (offset * R * u + t)
+		double scale = pick(calib_.range_scale, ch, 1);
+		double offset = pick(calib_.range_offset, ch, 0);
+
+		for (int i = 0; i < beams_; i++)
+		{
+			// base rotation folded into the azimuth
+			double h_rad = deg2rad(azimuth_[i]);
+			size_t idx = static_cast<size_t>(ch) * beams_ + i;
+
+			double lx = v_cos * cos(h_rad);
+			double ly = v_cos * sin(h_rad);
+			double lz = v_sin;
+
+			// unit direction in the output frame
+			double ux = rot[0][0] * lx + rot[0][1] * ly + rot[0][2] * lz;
+			double uy = rot[1][0] * lx + rot[1][1] * ly + rot[1][2] * lz;
+			double uz = rot[2][0] * lx + rot[2][1] * ly + rot[2][2] * lz;
+
+			dx_[idx] = static_cast<float>(scale * ux);
+			dy_[idx] = static_cast<float>(scale * uy);
+			dz_[idx] = static_cast<float>(scale * uz);
+
+			if (has_offset_)
+			{
+				// R * (offset * u) + t
+				ox_[idx] = static_cast<float>(offset * ux + pose_.x);
+				oy_[idx] = static_cast<float>(offset * uy + pose_.y);
+				oz_[idx] = static_cast<float>(offset * uz + pose_.z);
+			}
+		}
+	}
+}
+
+void kanavi_projection::project(const float *len, int ch, int count, float *x, float *y, float *z) const
+{
+	if (ch < 0 || ch >= channels_)
+	{
+		return;
+	}
+	if (count > beams_)
+	{
+		count = beams_;
+	}
+
+	if (has_offset_)
+	{
+		size_t row = static_cast<size_t>(ch) * beams_;
+		offset_kernel_(len, dirX(ch), dirY(ch), dirZ(ch), ox_.data() + row, oy_.data() + row, oz_.data() + row, count, x, y, z);
+		return;
+	}
+
+	kernel_(len, dirX(ch), dirY(ch), dirZ(ch), count, x, y, z);
+}
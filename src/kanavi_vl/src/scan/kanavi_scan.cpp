@@ -0,0 +1,53 @@
+#include "kanavi_scan.h"
+
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Construct a new kanavi scan::kanavi scan object
+ *
+ * @param projection beam azimuths [deg], base rotation and calibration included
+ */
+kanavi_scan::kanavi_scan(const kanavi_projection &projection)
+	: beams_(projection.getBeams()), max_deviation_(0)
+{
+	// uniform angles through the first and last beam, a common azimuth offset is kept exactly
+	double first = projection.getAzimuth(0);
+	double increment = (beams_ > 1) ? (projection.getAzimuth(beams_ - 1) - first) / (beams_ - 1)
+									: projection.getHorizontalResolution();
+
+	for (int i = 0; i < beams_; i++)
+	{
+		float deviation = static_cast<float>(std::fabs(projection.getAzimuth(i) - (first + increment * i)));
+		if (deviation > max_deviation_)
+		{
+			max_deviation_ = deviation;
+		}
+	}
+
+	angle_min_ = static_cast<float>(first * M_PI / 180.0);
+	angle_increment_ = static_cast<float>(increment * M_PI / 180.0);
+}
+
+kanavi_scan::~kanavi_scan()
+{
+}
+
+void kanavi_scan::write(float *dst, const float *len, int count) const
+{
+	const float no_return = std::numeric_limits<float>::infinity();
+
+	if (count > beams_)
+	{
+		count = beams_;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		dst[i] = (len[i] > 0) ? len[i] : no_return;
+	}
+	for (int i = count; i < beams_; i++)
+	{
+		dst[i] = no_return;
+	}
+}
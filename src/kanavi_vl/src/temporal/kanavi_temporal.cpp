@@ -0,0 +1,180 @@
+#include "kanavi_temporal.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	const float CM_PER_M = 100.0f;
+	const float RANGE_MAX_CM = 32767.0f;
+
+	// compare-exchange of a sorting network, a <= b afterwards
+	inline void sort2(int16_t &a, int16_t &b)
+	{
+		int16_t lo = std::min(a, b);
+		b = std::max(a, b);
+		a = lo;
+	}
+}
+
+/**
+ * @brief Construct a new kanavi temporal::kanavi temporal object
+ *
+ * @param mode median / persistence
+ * @param frames ring length
+ * @param tolerance persistence range agreement [m]
+ * @param channels grid channels
+ * @param beams grid beams per channel
+ */
+kanavi_temporal::kanavi_temporal(const std::string &mode, int frames, float tolerance, int channels, int beams)
+	: mode_(KANAVI::TEMPORAL::MODE_MEDIAN), mode_name_(mode), frames_(frames), tolerance_(0),
+	  channels_(channels), beams_(beams), grid_(0), head_(0), filled_(0)
+{
+	if (mode == KANAVI::TEMPORAL::MEDIAN)
+	{
+		mode_ = KANAVI::TEMPORAL::MODE_MEDIAN;
+		if (frames != 3 && frames != 5)
+		{
+			throw std::runtime_error("Invalid temporal median frames (3 or 5) : " + std::to_string(frames));
+		}
+	}
+	else if (mode == KANAVI::TEMPORAL::PERSISTENCE)
+	{
+		mode_ = KANAVI::TEMPORAL::MODE_PERSISTENCE;
+		if (frames < 2 || frames > KANAVI::TEMPORAL::MAX_FRAMES)
+		{
+			throw std::runtime_error("Invalid temporal persistence frames : " + std::to_string(frames));
+		}
+	}
+	else
+	{
+		throw std::runtime_error("Invalid temporal mode : " + mode);
+	}
+
+	if (channels <= 0 || beams <= 0)
+	{
+		throw std::runtime_error("Invalid temporal grid : " + std::to_string(channels) + " x " + std::to_string(beams));
+	}
+	if (!(tolerance >= 0))
+	{
+		throw std::runtime_error("Invalid temporal tolerance : " + std::to_string(tolerance));
+	}
+	tolerance_ = static_cast<int16_t>(std::min(tolerance * CM_PER_M + 0.5f, RANGE_MAX_CM));
+
+	grid_ = static_cast<size_t>(channels_) * beams_;
+	ring_.assign(grid_ * frames_, 0);
+	out_.resize(beams_);
+	hits_.resize(beams_);
+}
+
+kanavi_temporal::~kanavi_temporal()
+{
+}
+
+void kanavi_temporal::reset()
+{
+	head_ = 0;
+	filled_ = 0;
+}
+
+void kanavi_temporal::filter(std::vector< std::vector<float> > &len_buf)
+{
+	if (filled_ < frames_)
+	{
+		filled_++;
+	}
+
+	int channels = std::min(static_cast<int>(len_buf.size()), channels_);
+	for (int ch = 0; ch < channels; ch++)
+	{
+		std::vector<float> &len = len_buf[ch];
+		int count = std::min(static_cast<int>(len.size()), beams_);
+		size_t row = static_cast<size_t>(ch) * beams_;
+
+		// [m] -> [cm], a missing tail counts as no return
+		int16_t *cur = ring_.data() + head_ * grid_ + row;
+		for (int i = 0; i < count; i++)
+		{
+			float cm = std::min(std::max(len[i], 0.0f) * CM_PER_M + 0.5f, RANGE_MAX_CM);
+			cur[i] = static_cast<int16_t>(cm);
+		}
+		std::fill(cur + count, cur + beams_, 0);
+
+		if (filled_ < frames_)
+		{
+			continue;
+		}
+
+		if (mode_ == KANAVI::TEMPORAL::MODE_MEDIAN)
+		{
+			median(row, count, out_.data());
+		}
+		else
+		{
+			persistence(row, count, out_.data());
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			len[i] = out_[i] * (1.0f / CM_PER_M);
+		}
+	}
+
+	head_ = (head_ + 1) % frames_;
+}
+
+void kanavi_temporal::median(size_t row, int count, int16_t *out) const
+{
+	const int16_t *f[5];
+	for (int k = 0; k < frames_; k++)
+	{
+		f[k] = ring_.data() + k * grid_ + row;
+	}
+
+	if (frames_ == 3)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			int16_t a = f[0][i], b = f[1][i], c = f[2][i];
+			out[i] = std::max(std::min(a, b), std::min(std::max(a, b), c));
+		}
+		return;
+	}
+
+	// 7 exchange median-of-5 network
+	for (int i = 0; i < count; i++)
+	{
+		int16_t p0 = f[0][i], p1 = f[1][i], p2 = f[2][i], p3 = f[3][i], p4 = f[4][i];
+		sort2(p0, p1);
+		sort2(p3, p4);
+		sort2(p0, p3);
+		sort2(p1, p4);
+		sort2(p1, p2);
+		sort2(p2, p3);
+		sort2(p1, p2);
+		out[i] = p2;
+	}
+}
+
+void kanavi_temporal::persistence(size_t row, int count, int16_t *out)
+{
+	const int16_t *cur = ring_.data() + head_ * grid_ + row;
+	int16_t *hits = hits_.data();
+	std::fill(hits, hits + count, 0);
+
+	// the current frame counts itself for any return
+	for (int k = 0; k < frames_; k++)
+	{
+		const int16_t *other = ring_.data() + k * grid_ + row;
+		for (int i = 0; i < count; i++)
+		{
+			int d = other[i] - cur[i];
+			hits[i] += static_cast<int16_t>((d <= tolerance_) & (d >= -tolerance_) & (other[i] > 0));
+		}
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = static_cast<int16_t>(cur[i] & -static_cast<int16_t>(hits[i] >= frames_));
+	}
+}
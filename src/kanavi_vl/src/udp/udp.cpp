@@ -5,7 +5,7 @@ kanavi_udp::kanavi_udp(const std::string &local_ip_, const int &port_, const std
 	// init Unicast
 	if(init(local_ip_, port_, multicast_ip_, true) == -1)
 	{
-		exit(1);
+		throw std::runtime_error("[UDP] socket initialization failed");
 	}
 }
 
@@ -14,7 +14,7 @@ kanavi_udp::kanavi_udp(const std::string &local_ip_, const int &port_)
 	// init Unicast
 	if(init(local_ip_, port_) == -1)
 	{
-		exit(1);
+		throw std::runtime_error("[UDP] socket initialization failed");
 	}
 }
 
@@ -113,6 +113,8 @@ std::vector<u_char> kanavi_udp::getData()
 
 	if(size > 0)
 	{
+		g_senderIP = ip_str;
+
 		output.resize(size);
 
 		std::copy(g_udp_buf, g_udp_buf + size, output.begin());
@@ -0,0 +1,146 @@
+#include "kanavi_voxel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	const int64_t KEY_OFFSET = int64_t(1) << (KANAVI::VOXEL::KEY_BITS - 1);
+	const uint64_t KEY_MASK = (uint64_t(1) << KANAVI::VOXEL::KEY_BITS) - 1;
+
+	inline uint64_t packKey(float x, float y, float z, float inv_leaf)
+	{
+		uint64_t ix = static_cast<uint64_t>(static_cast<int64_t>(std::floor(x * inv_leaf)) + KEY_OFFSET) & KEY_MASK;
+		uint64_t iy = static_cast<uint64_t>(static_cast<int64_t>(std::floor(y * inv_leaf)) + KEY_OFFSET) & KEY_MASK;
+		uint64_t iz = static_cast<uint64_t>(static_cast<int64_t>(std::floor(z * inv_leaf)) + KEY_OFFSET) & KEY_MASK;
+		return (ix << (2 * KANAVI::VOXEL::KEY_BITS)) | (iy << KANAVI::VOXEL::KEY_BITS) | iz;
+	}
+
+	// fibonacci hashing, the table size is a power of 2
+	inline size_t hashKey(uint64_t key)
+	{
+		return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 20);
+	}
+}
+
+/**
+ * @brief Construct a new kanavi voxel::kanavi voxel object
+ *
+ * @param leaf voxel edge length [m]
+ * @param policy centroid / first
+ * @param capacity max points per frame
+ */
+kanavi_voxel::kanavi_voxel(float leaf, const std::string &policy, size_t capacity)
+	: policy_(KANAVI::VOXEL::POLICY_CENTROID), policy_name_(policy), leaf_(leaf), inv_leaf_(0), capacity_(capacity),
+	  mask_(0), gen_(1), used_(0)
+{
+	if (!(leaf > 0))
+	{
+		throw std::runtime_error("Invalid voxel size : " + std::to_string(leaf));
+	}
+	if (policy == KANAVI::VOXEL::CENTROID)
+	{
+		policy_ = KANAVI::VOXEL::POLICY_CENTROID;
+	}
+	else if (policy == KANAVI::VOXEL::FIRST)
+	{
+		policy_ = KANAVI::VOXEL::POLICY_FIRST;
+	}
+	else
+	{
+		throw std::runtime_error("Invalid voxel policy : " + policy);
+	}
+	inv_leaf_ = 1.0f / leaf_;
+
+	// load factor <= 0.5 keeps the linear probes short
+	size_t size = 16;
+	while (size < 2 * capacity_)
+	{
+		size <<= 1;
+	}
+	table_.assign(size, slot{0, 0, 0});
+	mask_ = size - 1;
+
+	x_.resize(capacity_);
+	y_.resize(capacity_);
+	z_.resize(capacity_);
+	len_.resize(capacity_);
+	count_.resize(capacity_);
+}
+
+kanavi_voxel::~kanavi_voxel()
+{
+}
+
+void kanavi_voxel::clear()
+{
+	used_ = 0;
+	if (++gen_ == 0)
+	{
+		// wrapped after 2^32 frames : the only full reset
+		std::fill(table_.begin(), table_.end(), slot{0, 0, 0});
+		gen_ = 1;
+	}
+}
+
+void kanavi_voxel::insert(const float *x, const float *y, const float *z, const float *len, const uint8_t *valid, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (valid && !valid[i])
+		{
+			continue;
+		}
+
+		uint64_t key = packKey(x[i], y[i], z[i], inv_leaf_);
+		size_t pos = hashKey(key) & mask_;
+		while (table_[pos].gen == gen_ && table_[pos].key != key)
+		{
+			pos = (pos + 1) & mask_;
+		}
+
+		slot &s = table_[pos];
+		if (s.gen != gen_)
+		{
+			if (used_ >= capacity_)
+			{
+				continue;
+			}
+			s.key = key;
+			s.gen = gen_;
+			s.index = static_cast<uint32_t>(used_++);
+
+			x_[s.index] = x[i];
+			y_[s.index] = y[i];
+			z_[s.index] = z[i];
+			len_[s.index] = len[i];
+			count_[s.index] = 1;
+		}
+		else if (policy_ == KANAVI::VOXEL::POLICY_CENTROID)
+		{
+			x_[s.index] += x[i];
+			y_[s.index] += y[i];
+			z_[s.index] += z[i];
+			len_[s.index] += len[i];
+			count_[s.index]++;
+		}
+	}
+}
+
+void kanavi_voxel::finish()
+{
+	if (policy_ != KANAVI::VOXEL::POLICY_CENTROID)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < used_; i++)
+	{
+		float inv = 1.0f / static_cast<float>(count_[i]);
+		x_[i] *= inv;
+		y_[i] *= inv;
+		z_[i] *= inv;
+		len_[i] *= inv;
+	}
+}
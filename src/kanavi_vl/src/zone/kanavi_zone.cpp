@@ -0,0 +1,317 @@
+#include "kanavi_zone.h"
+#include "kanavi_projection.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	std::string trim(const std::string &s)
+	{
+		size_t first = s.find_first_not_of(" \t\r\n");
+		if (first == std::string::npos)
+		{
+			return "";
+		}
+		size_t last = s.find_last_not_of(" \t\r\n");
+		return s.substr(first, last - first + 1);
+	}
+
+	bool parseList(const std::string &text, std::vector<float> &out)
+	{
+		std::string values = text;
+		std::replace(values.begin(), values.end(), ',', ' ');
+
+		std::istringstream ss(values);
+		std::string token;
+		out.clear();
+		while (ss >> token)
+		{
+			try
+			{
+				size_t used = 0;
+				out.push_back(std::stof(token, &used));
+				if (used != token.size())
+				{
+					return false;
+				}
+			}
+			catch (const std::exception &)
+			{
+				return false;
+			}
+		}
+		return !out.empty();
+	}
+
+	bool validName(const std::string &name)
+	{
+		if (name.empty())
+		{
+			return false;
+		}
+		for (char c : name)
+		{
+			if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// horizontal distances where the ray (cos a, sin a) * s crosses the polygon edges
+	void crossings(const std::vector<float> &polygon, double dx, double dy, std::vector<double> &out)
+	{
+		out.clear();
+		size_t n = polygon.size() / 2;
+		for (size_t i = 0; i < n; i++)
+		{
+			double px = polygon[2 * i], py = polygon[2 * i + 1];
+			double ex = polygon[2 * ((i + 1) % n)] - px, ey = polygon[2 * ((i + 1) % n) + 1] - py;
+
+			// s * d = p + u * e
+			double den = dx * ey - dy * ex;
+			if (std::fabs(den) < 1e-12)
+			{
+				continue;
+			}
+			double s = (px * ey - py * ex) / den;
+			double u = (px * dy - py * dx) / den;
+			if (u >= 0 && u < 1 && s > 0)
+			{
+				out.push_back(s);
+			}
+		}
+		std::sort(out.begin(), out.end());
+	}
+
+	// even-odd rule for the sensor origin
+	bool originInside(const std::vector<float> &polygon)
+	{
+		bool inside = false;
+		size_t n = polygon.size() / 2;
+		for (size_t i = 0, j = n - 1; i < n; j = i++)
+		{
+			double xi = polygon[2 * i], yi = polygon[2 * i + 1];
+			double xj = polygon[2 * j], yj = polygon[2 * j + 1];
+			if (((yi > 0) != (yj > 0)) && (0 < (xj - xi) * (0 - yi) / (yj - yi) + xi))
+			{
+				inside = !inside;
+			}
+		}
+		return inside;
+	}
+}
+
+/**
+ * @brief Construct a new kanavi zone::kanavi zone object
+ *
+ * @param path zone file
+ */
+kanavi_zone::kanavi_zone(const std::string &path)
+{
+	std::string error = load(path);
+	if (!error.empty())
+	{
+		throw std::runtime_error("Invalid zone file " + path + " : " + error);
+	}
+	if (zones_.empty())
+	{
+		throw std::runtime_error("No zone in " + path);
+	}
+
+	count_.assign(zones_.size(), 0);
+	occupied_.assign(zones_.size(), 0);
+	changed_.assign(zones_.size(), 0);
+}
+
+kanavi_zone::~kanavi_zone()
+{
+}
+
+std::string kanavi_zone::load(const std::string &path)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		return "can not open";
+	}
+
+	KANAVI::ZONE::zone *current = nullptr;
+	std::vector<float> values;
+	std::string line;
+	int line_no = 0;
+	while (std::getline(file, line))
+	{
+		line_no++;
+		std::string at = "line " + std::to_string(line_no);
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+		line = trim(line);
+		if (line.empty())
+		{
+			continue;
+		}
+
+		// [zone name]
+		if (line.front() == '[')
+		{
+			std::string name = (line.back() == ']' && line.size() >= 3) ? trim(line.substr(1, line.size() - 2)) : "";
+			if (!validName(name))
+			{
+				return at + ", invalid zone name";
+			}
+			for (const KANAVI::ZONE::zone &z : zones_)
+			{
+				if (z.name == name)
+				{
+					return at + ", duplicated zone " + name;
+				}
+			}
+			zones_.push_back(KANAVI::ZONE::zone());
+			current = &zones_.back();
+			current->name = name;
+			continue;
+		}
+
+		// key = values
+		size_t eq = line.find('=');
+		if (eq == std::string::npos || current == nullptr)
+		{
+			return at + ", expected key = values in a zone";
+		}
+
+		std::string key = trim(line.substr(0, eq));
+		if (!parseList(line.substr(eq + 1), values))
+		{
+			return at + ", invalid value of " + key;
+		}
+
+		if (key == KANAVI::ZONE::KEY_POLYGON && values.size() >= 6 && values.size() % 2 == 0)
+		{
+			current->polygon = values;
+		}
+		else if (key == KANAVI::ZONE::KEY_RANGE && values.size() == 2 && values[0] < values[1])
+		{
+			current->range_min = values[0];
+			current->range_max = values[1];
+		}
+		else if (key == KANAVI::ZONE::KEY_MIN_POINTS && values.size() == 1 && values[0] >= 1)
+		{
+			current->min_points = static_cast<int>(values[0]);
+		}
+		else
+		{
+			return at + ", invalid " + key;
+		}
+	}
+
+	for (const KANAVI::ZONE::zone &z : zones_)
+	{
+		if (z.polygon.empty())
+		{
+			return "zone " + z.name + " has no polygon";
+		}
+	}
+	return "";
+}
+
+void kanavi_zone::compile(const kanavi_projection &projection)
+{
+	int channels = projection.getChannels();
+	int beams = projection.getBeams();
+
+	first_.assign(channels + 1, 0);
+	beam_.clear();
+	zone_.clear();
+	lo_.clear();
+	hi_.clear();
+
+	std::vector<double> cross;
+	for (int ch = 0; ch < channels; ch++)
+	{
+		first_[ch] = static_cast<uint32_t>(beam_.size());
+
+		// range -> horizontal distance
+		double cos_e = std::cos(projection.getElevation(ch) * M_PI / 180.0);
+		if (cos_e < 1e-6)
+		{
+			continue;
+		}
+
+		for (int i = 0; i < beams; i++)
+		{
+			double a = projection.getAzimuth(i) * M_PI / 180.0;
+			double dx = std::cos(a), dy = std::sin(a);
+
+			for (size_t z = 0; z < zones_.size(); z++)
+			{
+				const KANAVI::ZONE::zone &zone = zones_[z];
+				crossings(zone.polygon, dx, dy, cross);
+
+				// walk the crossings, toggling inside / outside from the origin
+				bool inside = originInside(zone.polygon);
+				double start = 0;
+				for (size_t k = 0; k <= cross.size(); k++)
+				{
+					double s = (k < cross.size()) ? cross[k] : HUGE_VAL;
+					if (inside)
+					{
+						// zero returns never pass, lo > 0
+						double lo = std::max({start / cos_e, static_cast<double>(zone.range_min), static_cast<double>(FLT_MIN)});
+						double hi = std::min(s / cos_e, static_cast<double>(zone.range_max));
+						if (lo <= hi)
+						{
+							beam_.push_back(static_cast<uint16_t>(i));
+							zone_.push_back(static_cast<uint16_t>(z));
+							lo_.push_back(static_cast<float>(lo));
+							hi_.push_back(static_cast<float>(hi));
+						}
+					}
+					inside = !inside;
+					start = s;
+				}
+			}
+		}
+	}
+	first_[channels] = static_cast<uint32_t>(beam_.size());
+}
+
+bool kanavi_zone::evaluate(const std::vector< std::vector<float> > &len_buf)
+{
+	std::fill(count_.begin(), count_.end(), 0);
+
+	int channels = std::min(static_cast<int>(len_buf.size()), static_cast<int>(first_.size()) - 1);
+	for (int ch = 0; ch < channels; ch++)
+	{
+		const float *len = len_buf[ch].data();
+		uint32_t size = static_cast<uint32_t>(len_buf[ch].size());
+
+		for (uint32_t e = first_[ch]; e < first_[ch + 1]; e++)
+		{
+			uint32_t b = beam_[e];
+			float r = (b < size) ? len[b] : 0.0f;
+			count_[zone_[e]] += static_cast<uint32_t>((r >= lo_[e]) & (r <= hi_[e]));
+		}
+	}
+
+	bool changed = false;
+	for (size_t z = 0; z < zones_.size(); z++)
+	{
+		uint8_t occupied = static_cast<uint8_t>(count_[z] >= static_cast<uint32_t>(zones_[z].min_points));
+		changed_[z] = static_cast<uint8_t>(occupied != occupied_[z]);
+		changed |= (changed_[z] != 0);
+		occupied_[z] = occupied;
+	}
+	return changed;
+}